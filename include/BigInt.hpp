@@ -2,322 +2,3739 @@
 #ifndef __BIG_INT_HPP__
 #define __BIG_INT_HPP__
 
+#include <algorithm>
+#include <charconv>
+#include <cctype>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <deque>
+#include <initializer_list>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <string>
+#include <string_view>
 #include <ostream>
-#include <regex>
+#include <stdexcept>
 #include <tuple>
+#include <utility>
+#include <type_traits>
+#include <vector>
+
+// Width of the groups (limbs) of hausp::BigInt in bits: 64, using
+// unsigned __int128 for the double-width products, wherever the compiler
+// provides it, and 32 otherwise. May be defined to 32 beforehand to force
+// narrow groups; BasicBigInt takes either width explicitly.
+#ifndef HAUSP_BIGINT_GROUP_BITS
+#ifdef __SIZEOF_INT128__
+#define HAUSP_BIGINT_GROUP_BITS 64
+#else
+#define HAUSP_BIGINT_GROUP_BITS 32
+#endif
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define HAUSP_BIGINT_X86 1
+#include <immintrin.h>
+#else
+#define HAUSP_BIGINT_X86 0
+#endif
 
 namespace hausp {
-    class BigInt {
-        // Friend non-member operators
-        friend std::ostream& operator<<(std::ostream&, const BigInt&);
-        friend bool operator==(const BigInt&, const BigInt&);
-        friend bool operator<(const BigInt&, const BigInt&);
-        // Aliases
-        using Group = uint32_t;
-        using SignedGroup = int64_t;
-        using DoubleGroup = uint64_t;
-        using GroupVector = std::deque<Group>;
-        // Constant values
-        static constexpr auto GROUP_MAX = 0xffffffff;
-        static constexpr auto GROUP_RADIX = 0x100000000;
-        static constexpr auto GROUP_BIT_SIZE = 32;
-        static constexpr auto POSITIVE = false;
-        static constexpr auto NEGATIVE = true;
+    // Instruction set levels the hot kernels are built for, each one
+    // including the ones before it: ADX stands for AVX2 plus BMI2 and ADX,
+    // AVX512 for that plus AVX-512 IFMA. The best level the CPU supports
+    // is picked once per process; the environment variable
+    // HAUSP_BIGINT_CPU (scalar, sse4.1, avx2, adx or avx512) lowers it,
+    // for benchmarking and testing.
+    enum class CpuLevel { SCALAR, SSE41, AVX2, ADX, AVX512 };
+
+    namespace detail {
+        // Contiguous, growable storage for the groups of a BigInt. The first
+        // N groups live inside the object itself, so small values never
+        // touch the allocator. Only the subset of std::vector needed by
+        // BigInt is provided; removing elements never releases memory, it
+        // just adjusts the length. Heap memory comes from Allocator, which
+        // follows the usual propagation rules of allocator-aware containers.
+        template<typename T, size_t N, typename Allocator = std::allocator<T>>
+        class GroupBuffer : private Allocator {
+            static_assert(std::is_trivially_copyable<T>::value,
+                          "GroupBuffer only holds trivially copyable types");
+            static_assert(N > 0, "GroupBuffer needs at least one inline group");
+            using Traits = std::allocator_traits<Allocator>;
+         public:
+            using value_type = T;
+            using allocator_type = Allocator;
+            using iterator = T*;
+            using const_iterator = const T*;
+
+            GroupBuffer() = default;
+            explicit GroupBuffer(const Allocator& allocator):
+             Allocator(allocator) { }
+            GroupBuffer(size_t, const T&, const Allocator& = Allocator());
+            GroupBuffer(std::initializer_list<T>);
+            GroupBuffer(const GroupBuffer&);
+            GroupBuffer(const GroupBuffer&, const Allocator&);
+            GroupBuffer(GroupBuffer&&) noexcept;
+            GroupBuffer(GroupBuffer&&, const Allocator&);
+            ~GroupBuffer();
+
+            GroupBuffer& operator=(const GroupBuffer&);
+            GroupBuffer& operator=(GroupBuffer&&) noexcept;
+
+            T& operator[](size_t i) { return groups[i]; }
+            const T& operator[](size_t i) const { return groups[i]; }
+            T& front() { return groups[0]; }
+            const T& front() const { return groups[0]; }
+            T& back() { return groups[length - 1]; }
+            const T& back() const { return groups[length - 1]; }
+            T* data() { return groups; }
+            const T* data() const { return groups; }
+            iterator begin() { return groups; }
+            const_iterator begin() const { return groups; }
+            iterator end() { return groups + length; }
+            const_iterator end() const { return groups + length; }
+            const_iterator cbegin() const { return groups; }
+            const_iterator cend() const { return groups + length; }
+
+            bool empty() const { return length == 0; }
+            size_t size() const { return length; }
+            size_t capacity() const { return allocated; }
+            bool isInline() const { return groups == local; }
+            allocator_type get_allocator() const { return allocator(); }
+
+            void reserve(size_t);
+            void resize(size_t, const T& = T());
+            void assign(const T*, const T*);
+            void clear() { length = 0; }
+            void push_back(const T&);
+            void emplace_back(const T&);
+            void pop_back() { --length; }
+            iterator insert(const_iterator, size_t, const T&);
+            iterator erase(const_iterator, const_iterator);
+            void swap(GroupBuffer&) noexcept;
+
+         private:
+            T* groups = local;
+            size_t length = 0;
+            size_t allocated = N;
+            T local[N];
+
+            Allocator& allocator() { return *this; }
+            const Allocator& allocator() const { return *this; }
+            void grow(size_t);
+            void release();
+            void steal(GroupBuffer&);
+        };
+
+        template<typename T, size_t N, typename Allocator>
+        GroupBuffer<T, N, Allocator>::GroupBuffer(size_t count, const T& value,
+                                                  const Allocator& allocator):
+         Allocator(allocator) {
+            resize(count, value);
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        GroupBuffer<T, N, Allocator>::GroupBuffer(
+            std::initializer_list<T> values) {
+            reserve(values.size());
+            std::copy(values.begin(), values.end(), groups);
+            length = values.size();
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        GroupBuffer<T, N, Allocator>::GroupBuffer(const GroupBuffer& other):
+         Allocator(Traits::select_on_container_copy_construction(
+             other.allocator())) {
+            assign(other.begin(), other.end());
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        GroupBuffer<T, N, Allocator>::GroupBuffer(const GroupBuffer& other,
+                                                  const Allocator& allocator):
+         Allocator(allocator) {
+            assign(other.begin(), other.end());
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        GroupBuffer<T, N, Allocator>::GroupBuffer(GroupBuffer&& other) noexcept:
+         Allocator(std::move(other.allocator())) {
+            steal(other);
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        GroupBuffer<T, N, Allocator>::GroupBuffer(GroupBuffer&& other,
+                                                  const Allocator& allocator):
+         Allocator(allocator) {
+            if (other.isInline() || this->allocator() == other.allocator()) {
+                steal(other);
+            } else {
+                assign(other.begin(), other.end());
+            }
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        GroupBuffer<T, N, Allocator>::~GroupBuffer() {
+            release();
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        GroupBuffer<T, N, Allocator>&
+        GroupBuffer<T, N, Allocator>::operator=(const GroupBuffer& other) {
+            if (this != &other) {
+                if constexpr (Traits::propagate_on_container_copy_assignment::value) {
+                    if (allocator() != other.allocator()) {
+                        release();
+                        allocator() = other.allocator();
+                    }
+                }
+                assign(other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        GroupBuffer<T, N, Allocator>&
+        GroupBuffer<T, N, Allocator>::operator=(GroupBuffer&& other) noexcept {
+            if (this != &other) {
+                if constexpr (Traits::propagate_on_container_move_assignment::value) {
+                    if (allocator() != other.allocator()) {
+                        release();
+                        allocator() = std::move(other.allocator());
+                    }
+                }
+                if (other.isInline()) {
+                    // Whatever we hold is at least N groups wide
+                    std::memcpy(groups, other.groups, other.length * sizeof(T));
+                    length = other.length;
+                    other.length = 0;
+                } else if (allocator() == other.allocator()) {
+                    release();
+                    steal(other);
+                } else {
+                    // Memory of other can't be freed through our allocator
+                    *this = static_cast<const GroupBuffer&>(other);
+                }
+            }
+            return *this;
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        void GroupBuffer<T, N, Allocator>::reserve(size_t count) {
+            if (count > allocated) {
+                auto new_groups = Traits::allocate(allocator(), count);
+                std::memcpy(new_groups, groups, length * sizeof(T));
+                release();
+                groups = new_groups;
+                allocated = count;
+            }
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        void GroupBuffer<T, N, Allocator>::resize(size_t count,
+                                                  const T& value) {
+            if (count > length) {
+                T fill = value;
+                grow(count);
+                std::fill(groups + length, groups + count, fill);
+            }
+            length = count;
+        }
+
+        // Replaces the contents with [first, last), which must not lie
+        // inside the buffer, reusing its memory when it is large enough.
+        template<typename T, size_t N, typename Allocator>
+        void GroupBuffer<T, N, Allocator>::assign(const T* first,
+                                                  const T* last) {
+            size_t count = last - first;
+            length = 0;
+            reserve(count);
+            std::memcpy(groups, first, count * sizeof(T));
+            length = count;
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        void GroupBuffer<T, N, Allocator>::push_back(const T& value) {
+            T copy = value;
+            grow(length + 1);
+            groups[length++] = copy;
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        void GroupBuffer<T, N, Allocator>::emplace_back(const T& value) {
+            push_back(value);
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        typename GroupBuffer<T, N, Allocator>::iterator
+        GroupBuffer<T, N, Allocator>::insert(const_iterator position,
+                                             size_t count, const T& value) {
+            size_t offset = position - groups;
+            T fill = value;
+            grow(length + count);
+            std::memmove(groups + offset + count, groups + offset,
+                         (length - offset) * sizeof(T));
+            std::fill(groups + offset, groups + offset + count, fill);
+            length += count;
+            return groups + offset;
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        typename GroupBuffer<T, N, Allocator>::iterator
+        GroupBuffer<T, N, Allocator>::erase(const_iterator first,
+                                            const_iterator last) {
+            size_t offset = first - groups;
+            size_t count = last - first;
+            std::memmove(groups + offset, groups + offset + count,
+                         (length - offset - count) * sizeof(T));
+            length -= count;
+            return groups + offset;
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        void GroupBuffer<T, N, Allocator>::swap(GroupBuffer& other) noexcept {
+            GroupBuffer temporary(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temporary);
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        void GroupBuffer<T, N, Allocator>::grow(size_t count) {
+            if (count > allocated) {
+                reserve(std::max(count, allocated + allocated / 2));
+            }
+        }
+
+        template<typename T, size_t N, typename Allocator>
+        void GroupBuffer<T, N, Allocator>::release() {
+            if (!isInline()) {
+                Traits::deallocate(allocator(), groups, allocated);
+                groups = local;
+                allocated = N;
+            }
+        }
+
+        // Takes over the contents of other, leaving it empty and inline.
+        // Assumes *this holds no heap memory.
+        template<typename T, size_t N, typename Allocator>
+        void GroupBuffer<T, N, Allocator>::steal(GroupBuffer& other) {
+            if (other.isInline()) {
+                std::memcpy(local, other.local, other.length * sizeof(T));
+                groups = local;
+                allocated = N;
+            } else {
+                groups = other.groups;
+                allocated = other.allocated;
+                other.groups = other.local;
+                other.allocated = N;
+            }
+            length = other.length;
+            other.length = 0;
+        }
+
+        // Conversion between runs of 9-digit decimal fragments and their
+        // values, the basecase of every decimal conversion. Fragments are
+        // stored least significant first: fragment i is the text at
+        // text + 9 * (count - 1 - i). The SIMD kernels handle the low 8
+        // digits of each fragment and leave the leading one to scalar code.
+        inline void parseFragmentsScalar(const char* text, size_t count,
+                                         uint32_t* fragments) {
+            for (size_t i = count; i > 0; --i, text += 9) {
+                uint32_t value = 0;
+                for (size_t j = 0; j < 9; ++j) {
+                    value = value * 10 + (text[j] - '0');
+                }
+                fragments[i - 1] = value;
+            }
+        }
+
+        inline void formatFragmentsScalar(const uint32_t* fragments,
+                                          size_t count, char* text) {
+            for (size_t i = count; i > 0; --i, text += 9) {
+                auto value = fragments[i - 1];
+                for (size_t j = 9; j > 0; --j) {
+                    text[j - 1] = '0' + value % 10;
+                    value /= 10;
+                }
+            }
+        }
+
+#if HAUSP_BIGINT_X86
+        inline uint64_t loadDigits(const char* text) {
+            uint64_t digits;
+            std::memcpy(&digits, text, sizeof(digits));
+            return digits;
+        }
+
+        inline void storeDigits(char* text, uint64_t digits) {
+            std::memcpy(text, &digits, sizeof(digits));
+        }
+
+        // Two fragments per 16 bytes: pairs of digits, then quadruples,
+        // then the 8-digit values, each step a multiply-add of adjacent
+        // lanes.
+        __attribute__((target("sse4.1")))
+        inline void parseFragmentsSse41(const char* text, size_t count,
+                                        uint32_t* fragments) {
+            const auto zeros = _mm_set1_epi8('0');
+            const auto tens = _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+                                            10, 1, 10, 1, 10, 1, 10, 1);
+            const auto hundreds = _mm_setr_epi16(100, 1, 100, 1,
+                                                 100, 1, 100, 1);
+            const auto ten_thousands = _mm_setr_epi16(10000, 1, 10000, 1,
+                                                      10000, 1, 10000, 1);
+            size_t i = count;
+            for (; i >= 2; i -= 2, text += 18) {
+                auto digits = _mm_set_epi64x(loadDigits(text + 10),
+                                             loadDigits(text + 1));
+                digits = _mm_sub_epi8(digits, zeros);
+                auto pairs = _mm_maddubs_epi16(digits, tens);
+                auto quads = _mm_madd_epi16(pairs, hundreds);
+                quads = _mm_packus_epi32(quads, quads);
+                auto values = _mm_madd_epi16(quads, ten_thousands);
+                fragments[i - 1] = (text[0] - '0') * 100000000u
+                                 + _mm_cvtsi128_si32(values);
+                fragments[i - 2] = (text[9] - '0') * 100000000u
+                                 + _mm_extract_epi32(values, 1);
+            }
+            parseFragmentsScalar(text, i, fragments);
+        }
+
+        __attribute__((target("avx2")))
+        inline void parseFragmentsAvx2(const char* text, size_t count,
+                                       uint32_t* fragments) {
+            const auto zeros = _mm256_set1_epi8('0');
+            const auto tens = _mm256_setr_epi8(
+                10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1,
+                10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1);
+            const auto hundreds = _mm256_setr_epi16(
+                100, 1, 100, 1, 100, 1, 100, 1,
+                100, 1, 100, 1, 100, 1, 100, 1);
+            const auto ten_thousands = _mm256_setr_epi16(
+                10000, 1, 10000, 1, 10000, 1, 10000, 1,
+                10000, 1, 10000, 1, 10000, 1, 10000, 1);
+            size_t i = count;
+            for (; i >= 4; i -= 4, text += 36) {
+                auto digits = _mm256_set_epi64x(
+                    loadDigits(text + 28), loadDigits(text + 19),
+                    loadDigits(text + 10), loadDigits(text + 1));
+                digits = _mm256_sub_epi8(digits, zeros);
+                auto pairs = _mm256_maddubs_epi16(digits, tens);
+                auto quads = _mm256_madd_epi16(pairs, hundreds);
+                quads = _mm256_packus_epi32(quads, quads);
+                auto values = _mm256_madd_epi16(quads, ten_thousands);
+                fragments[i - 1] = (text[0] - '0') * 100000000u
+                                 + _mm256_extract_epi32(values, 0);
+                fragments[i - 2] = (text[9] - '0') * 100000000u
+                                 + _mm256_extract_epi32(values, 1);
+                fragments[i - 3] = (text[18] - '0') * 100000000u
+                                 + _mm256_extract_epi32(values, 4);
+                fragments[i - 4] = (text[27] - '0') * 100000000u
+                                 + _mm256_extract_epi32(values, 5);
+            }
+            parseFragmentsSse41(text, i, fragments);
+        }
+
+        // The 8 digits of abcdefgh in 16-bit lanes: it is split into abcd
+        // and efgh, each broadcast to four lanes and divided by 1000, 100,
+        // 10 and 1 with fixed-point multiplies, leaving a, ab, abc, abcd;
+        // subtracting ten times the lane before isolates the digits.
+        __attribute__((target("sse4.1")))
+        inline __m128i lowDigitsSse41(uint32_t value) {
+            const auto divisors = _mm_setr_epi16(
+                8389, 5243, 13108, short(32768),
+                8389, 5243, 13108, short(32768));
+            const auto shifts = _mm_setr_epi16(
+                128, 2048, 8192, short(32768), 128, 2048, 8192, short(32768));
+            auto whole = _mm_cvtsi32_si128(value);
+            auto high = _mm_srli_epi64(
+                _mm_mul_epu32(whole, _mm_set1_epi32(0xd1b71759)), 45);
+            auto low = _mm_sub_epi32(
+                whole, _mm_mul_epu32(high, _mm_set1_epi32(10000)));
+            auto halves = _mm_slli_epi64(_mm_unpacklo_epi16(high, low), 2);
+            halves = _mm_unpacklo_epi16(halves, halves);
+            auto spread = _mm_unpacklo_epi32(halves, halves);
+            auto prefixes = _mm_mulhi_epu16(
+                _mm_mulhi_epu16(spread, divisors), shifts);
+            auto tens = _mm_slli_epi64(
+                _mm_mullo_epi16(prefixes, _mm_set1_epi16(10)), 16);
+            return _mm_sub_epi16(prefixes, tens);
+        }
+
+        __attribute__((target("sse4.1")))
+        inline void formatFragmentsSse41(const uint32_t* fragments,
+                                         size_t count, char* text) {
+            const auto zeros = _mm_set1_epi8('0');
+            size_t i = count;
+            for (; i >= 2; i -= 2, text += 18) {
+                auto first = fragments[i - 1];
+                auto second = fragments[i - 2];
+                text[0] = '0' + first / 100000000;
+                text[9] = '0' + second / 100000000;
+                auto digits = _mm_packus_epi16(
+                    lowDigitsSse41(first % 100000000),
+                    lowDigitsSse41(second % 100000000));
+                digits = _mm_add_epi8(digits, zeros);
+                storeDigits(text + 1, _mm_cvtsi128_si64(digits));
+                storeDigits(text + 10, _mm_extract_epi64(digits, 1));
+            }
+            formatFragmentsScalar(fragments, i, text);
+        }
+
+        // As lowDigitsSse41, for one value in each 128-bit lane
+        __attribute__((target("avx2")))
+        inline __m256i lowDigitsAvx2(uint32_t first, uint32_t second) {
+            const auto divisors = _mm256_setr_epi16(
+                8389, 5243, 13108, short(32768), 8389, 5243, 13108, short(32768),
+                8389, 5243, 13108, short(32768), 8389, 5243, 13108, short(32768));
+            const auto shifts = _mm256_setr_epi16(
+                128, 2048, 8192, short(32768), 128, 2048, 8192, short(32768),
+                128, 2048, 8192, short(32768), 128, 2048, 8192, short(32768));
+            auto whole = _mm256_setr_epi32(first, 0, 0, 0, second, 0, 0, 0);
+            auto high = _mm256_srli_epi64(
+                _mm256_mul_epu32(whole, _mm256_set1_epi32(0xd1b71759)), 45);
+            auto low = _mm256_sub_epi32(
+                whole, _mm256_mul_epu32(high, _mm256_set1_epi32(10000)));
+            auto halves = _mm256_slli_epi64(_mm256_unpacklo_epi16(high, low), 2);
+            halves = _mm256_unpacklo_epi16(halves, halves);
+            auto spread = _mm256_unpacklo_epi32(halves, halves);
+            auto prefixes = _mm256_mulhi_epu16(
+                _mm256_mulhi_epu16(spread, divisors), shifts);
+            auto tens = _mm256_slli_epi64(
+                _mm256_mullo_epi16(prefixes, _mm256_set1_epi16(10)), 16);
+            return _mm256_sub_epi16(prefixes, tens);
+        }
+
+        __attribute__((target("avx2")))
+        inline void formatFragmentsAvx2(const uint32_t* fragments,
+                                        size_t count, char* text) {
+            const auto zeros = _mm256_set1_epi8('0');
+            size_t i = count;
+            for (; i >= 4; i -= 4, text += 36) {
+                uint32_t values[4];
+                for (size_t j = 0; j < 4; ++j) {
+                    values[j] = fragments[i - 1 - j] % 100000000;
+                    text[9 * j] = '0' + fragments[i - 1 - j] / 100000000;
+                }
+                // The pack interleaves the 128-bit lanes, leaving the
+                // values in the order 0, 2, 1, 3
+                auto digits = _mm256_packus_epi16(
+                    lowDigitsAvx2(values[0], values[1]),
+                    lowDigitsAvx2(values[2], values[3]));
+                digits = _mm256_add_epi8(digits, zeros);
+                storeDigits(text + 1, _mm256_extract_epi64(digits, 0));
+                storeDigits(text + 19, _mm256_extract_epi64(digits, 1));
+                storeDigits(text + 10, _mm256_extract_epi64(digits, 2));
+                storeDigits(text + 28, _mm256_extract_epi64(digits, 3));
+            }
+            formatFragmentsSse41(fragments, i, text);
+        }
+#endif
+
+        using ParseFragments = void (*)(const char*, size_t, uint32_t*);
+        using FormatFragments = void (*)(const uint32_t*, size_t, char*);
+
+        // The unsigned type holding the product of two groups
+        template<typename T>
+        struct DoubleWidth;
+
+        template<>
+        struct DoubleWidth<uint32_t> {
+            using type = uint64_t;
+        };
+
+#ifdef __SIZEOF_INT128__
+        template<>
+        struct DoubleWidth<uint64_t> {
+            using type = unsigned __int128;
+        };
+#endif
+
+        // Portable basecase kernels, each taking a carry (or borrow) in
+        // and returning the one out. These are the loops every other
+        // multiplication and addition bottoms out in.
+
+        // r[0..n) = a[0..n) * b + carry. r may alias a.
+        template<typename T>
+        T mulGroups1Scalar(T* r, const T* a, size_t n, T b, T carry) {
+            using Wide = typename DoubleWidth<T>::type;
+            for (size_t i = 0; i < n; ++i) {
+                Wide result = b;
+                result = result * a[i] + carry;
+                r[i] = result;
+                carry = result >> (8 * sizeof(T));
+            }
+            return carry;
+        }
+
+        // r[0..n) += a[0..n) * b + carry
+        template<typename T>
+        T addMulGroups1Scalar(T* r, const T* a, size_t n, T b, T carry) {
+            using Wide = typename DoubleWidth<T>::type;
+            for (size_t i = 0; i < n; ++i) {
+                Wide result = b;
+                result = r[i] + result * a[i] + carry;
+                r[i] = result;
+                carry = result >> (8 * sizeof(T));
+            }
+            return carry;
+        }
+
+        // r[0..n) = a[0..n) + b[0..n) + carry. r may alias a or b.
+        template<typename T>
+        T addGroupsScalar(T* r, const T* a, const T* b, size_t n, T carry) {
+            for (size_t i = 0; i < n; ++i) {
+                T sum = a[i] + carry;
+                carry = sum < carry;
+                r[i] = sum + b[i];
+                carry += r[i] < sum;
+            }
+            return carry;
+        }
+
+        // r[0..n) = a[0..n) - b[0..n) - borrow. r may alias a or b.
+        template<typename T>
+        T subGroupsScalar(T* r, const T* a, const T* b, size_t n, T borrow) {
+            for (size_t i = 0; i < n; ++i) {
+                T difference = a[i] - borrow;
+                borrow = a[i] < borrow;
+                borrow += difference < b[i];
+                r[i] = difference - b[i];
+            }
+            return borrow;
+        }
+
+        // r[0..n) = a[0..n) << shift, returning the bits shifted out of the
+        // top, with 0 < shift < the width of T. r may be a or above it.
+        template<typename T>
+        T shiftLeftGroupsScalar(T* r, const T* a, size_t n, unsigned shift) {
+            constexpr unsigned BITS = 8 * sizeof(T);
+            if (n == 0) {
+                return 0;
+            }
+            T out = a[n - 1] >> (BITS - shift);
+            for (size_t i = n - 1; i > 0; --i) {
+                r[i] = (a[i] << shift) | (a[i - 1] >> (BITS - shift));
+            }
+            r[0] = a[0] << shift;
+            return out;
+        }
+
+        // r[0..n) = a[0..n) >> shift, returning the bits shifted out of the
+        // bottom in the top of the result. r may be a or below it.
+        template<typename T>
+        T shiftRightGroupsScalar(T* r, const T* a, size_t n, unsigned shift) {
+            constexpr unsigned BITS = 8 * sizeof(T);
+            if (n == 0) {
+                return 0;
+            }
+            T out = a[0] << (BITS - shift);
+            for (size_t i = 0; i + 1 < n; ++i) {
+                r[i] = (a[i] >> shift) | (a[i + 1] << (BITS - shift));
+            }
+            r[n - 1] = a[n - 1] >> shift;
+            return out;
+        }
+
+#if HAUSP_BIGINT_X86
+        // The same shifts a vector of groups at a time, each combined with
+        // the neighbouring vector one group over. They walk in the same
+        // direction as the scalar loops, so they work in place as well.
+        // The upper halves are cleared before the scalar tail, which the
+        // compiler does not do for us ahead of a call, so the SSE code
+        // that follows does not pay for the transition.
+        template<typename T>
+        __attribute__((target("avx2")))
+        inline __m256i shiftLanesAvx2(__m256i value, __m128i shift) {
+            if constexpr (sizeof(T) == 8) {
+                return _mm256_sll_epi64(value, shift);
+            } else {
+                return _mm256_sll_epi32(value, shift);
+            }
+        }
+
+        template<typename T>
+        __attribute__((target("avx2")))
+        inline __m256i unshiftLanesAvx2(__m256i value, __m128i shift) {
+            if constexpr (sizeof(T) == 8) {
+                return _mm256_srl_epi64(value, shift);
+            } else {
+                return _mm256_srl_epi32(value, shift);
+            }
+        }
+
+        template<typename T>
+        __attribute__((target("avx2")))
+        T shiftLeftGroupsAvx2(T* r, const T* a, size_t n, unsigned shift) {
+            constexpr size_t LANES = sizeof(__m256i) / sizeof(T);
+            constexpr unsigned BITS = 8 * sizeof(T);
+            if (n == 0) {
+                return 0;
+            }
+            T out = a[n - 1] >> (BITS - shift);
+            auto left = _mm_cvtsi32_si128(shift);
+            auto right = _mm_cvtsi32_si128(BITS - shift);
+            size_t i = n;
+            for (; i > LANES; i -= LANES) {
+                auto high = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(a + i - LANES));
+                auto low = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(a + i - LANES - 1));
+                auto value = _mm256_or_si256(shiftLanesAvx2<T>(high, left),
+                                             unshiftLanesAvx2<T>(low, right));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i - LANES),
+                                    value);
+            }
+            _mm256_zeroupper();
+            shiftLeftGroupsScalar(r, a, i, shift);
+            return out;
+        }
+
+        template<typename T>
+        __attribute__((target("avx2")))
+        T shiftRightGroupsAvx2(T* r, const T* a, size_t n, unsigned shift) {
+            constexpr size_t LANES = sizeof(__m256i) / sizeof(T);
+            constexpr unsigned BITS = 8 * sizeof(T);
+            if (n == 0) {
+                return 0;
+            }
+            T out = a[0] << (BITS - shift);
+            auto right = _mm_cvtsi32_si128(shift);
+            auto left = _mm_cvtsi32_si128(BITS - shift);
+            size_t i = 0;
+            for (; i + LANES < n; i += LANES) {
+                auto low = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(a + i));
+                auto high = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(a + i + 1));
+                auto value = _mm256_or_si256(unshiftLanesAvx2<T>(low, right),
+                                             shiftLanesAvx2<T>(high, left));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), value);
+            }
+            _mm256_zeroupper();
+            shiftRightGroupsScalar(r + i, a + i, n - i, shift);
+            return out;
+        }
+#endif
+
+#if HAUSP_BIGINT_X86 && defined(__x86_64__)
+        // The same kernels for 64-bit groups with BMI2 and ADX. The
+        // assembly handles four groups per iteration and leaves the last
+        // n % 4 to the portable loops. Loop control is lea/jrcxz, which
+        // leave the flags alone, so the carries stay in CF and OF across
+        // iterations. mulx takes its multiplier from rdx.
+        __attribute__((target("bmi2,adx")))
+        inline uint64_t mulGroups1Adx(uint64_t* r, const uint64_t* a,
+                                      size_t n, uint64_t b, uint64_t carry) {
+            auto blocks = n & ~size_t(3);
+            if (blocks) {
+                auto index = -static_cast<ptrdiff_t>(blocks);
+                asm volatile(
+                    "xor %%r9d, %%r9d\n\t"
+                    "1:\n\t"
+                    "mulx (%[a],%[i],8), %%r9, %%r10\n\t"
+                    "adcx %[c], %%r9\n\t"
+                    "mov %%r9, (%[r],%[i],8)\n\t"
+                    "mulx 8(%[a],%[i],8), %%r9, %[c]\n\t"
+                    "adcx %%r10, %%r9\n\t"
+                    "mov %%r9, 8(%[r],%[i],8)\n\t"
+                    "mulx 16(%[a],%[i],8), %%r9, %%r10\n\t"
+                    "adcx %[c], %%r9\n\t"
+                    "mov %%r9, 16(%[r],%[i],8)\n\t"
+                    "mulx 24(%[a],%[i],8), %%r9, %[c]\n\t"
+                    "adcx %%r10, %%r9\n\t"
+                    "mov %%r9, 24(%[r],%[i],8)\n\t"
+                    "lea 4(%[i]), %[i]\n\t"
+                    "jrcxz 2f\n\t"
+                    "jmp 1b\n"
+                    "2:\n\t"
+                    "mov $0, %%r9d\n\t"
+                    "adcx %%r9, %[c]\n\t"
+                    : [c] "+&r"(carry), [i] "+&c"(index)
+                    : [r] "r"(r + blocks), [a] "r"(a + blocks), "d"(b)
+                    : "r9", "r10", "cc", "memory");
+            }
+            return mulGroups1Scalar(r + blocks, a + blocks, n - blocks,
+                                    b, carry);
+        }
+
+        // Two independent carry chains: adcx adds the high half of the
+        // previous product into the low half of the current one, while
+        // adox adds the result into r.
+        __attribute__((target("bmi2,adx")))
+        inline uint64_t addMulGroups1Adx(uint64_t* r, const uint64_t* a,
+                                         size_t n, uint64_t b,
+                                         uint64_t carry) {
+            auto blocks = n & ~size_t(3);
+            if (blocks) {
+                auto index = -static_cast<ptrdiff_t>(blocks);
+                asm volatile(
+                    "xor %%r9d, %%r9d\n\t"
+                    "1:\n\t"
+                    "mulx (%[a],%[i],8), %%r9, %%r10\n\t"
+                    "adcx %[c], %%r9\n\t"
+                    "adox (%[r],%[i],8), %%r9\n\t"
+                    "mov %%r9, (%[r],%[i],8)\n\t"
+                    "mulx 8(%[a],%[i],8), %%r9, %[c]\n\t"
+                    "adcx %%r10, %%r9\n\t"
+                    "adox 8(%[r],%[i],8), %%r9\n\t"
+                    "mov %%r9, 8(%[r],%[i],8)\n\t"
+                    "mulx 16(%[a],%[i],8), %%r9, %%r10\n\t"
+                    "adcx %[c], %%r9\n\t"
+                    "adox 16(%[r],%[i],8), %%r9\n\t"
+                    "mov %%r9, 16(%[r],%[i],8)\n\t"
+                    "mulx 24(%[a],%[i],8), %%r9, %[c]\n\t"
+                    "adcx %%r10, %%r9\n\t"
+                    "adox 24(%[r],%[i],8), %%r9\n\t"
+                    "mov %%r9, 24(%[r],%[i],8)\n\t"
+                    "lea 4(%[i]), %[i]\n\t"
+                    "jrcxz 2f\n\t"
+                    "jmp 1b\n"
+                    "2:\n\t"
+                    "mov $0, %%r9d\n\t"
+                    "adcx %%r9, %[c]\n\t"
+                    "adox %%r9, %[c]\n\t"
+                    : [c] "+&r"(carry), [i] "+&c"(index)
+                    : [r] "r"(r + blocks), [a] "r"(a + blocks), "d"(b)
+                    : "r9", "r10", "cc", "memory");
+            }
+            return addMulGroups1Scalar(r + blocks, a + blocks, n - blocks,
+                                       b, carry);
+        }
+
+        // add $-1 moves a carry of 1 into CF
+        __attribute__((target("bmi2,adx")))
+        inline uint64_t addGroupsAdx(uint64_t* r, const uint64_t* a,
+                                     const uint64_t* b, size_t n,
+                                     uint64_t carry) {
+            auto blocks = n & ~size_t(3);
+            if (blocks) {
+                auto index = -static_cast<ptrdiff_t>(blocks);
+                asm volatile(
+                    "add $-1, %[c]\n\t"
+                    "1:\n\t"
+                    "mov (%[a],%[i],8), %%r9\n\t"
+                    "adc (%[b],%[i],8), %%r9\n\t"
+                    "mov %%r9, (%[r],%[i],8)\n\t"
+                    "mov 8(%[a],%[i],8), %%r9\n\t"
+                    "adc 8(%[b],%[i],8), %%r9\n\t"
+                    "mov %%r9, 8(%[r],%[i],8)\n\t"
+                    "mov 16(%[a],%[i],8), %%r9\n\t"
+                    "adc 16(%[b],%[i],8), %%r9\n\t"
+                    "mov %%r9, 16(%[r],%[i],8)\n\t"
+                    "mov 24(%[a],%[i],8), %%r9\n\t"
+                    "adc 24(%[b],%[i],8), %%r9\n\t"
+                    "mov %%r9, 24(%[r],%[i],8)\n\t"
+                    "lea 4(%[i]), %[i]\n\t"
+                    "jrcxz 2f\n\t"
+                    "jmp 1b\n"
+                    "2:\n\t"
+                    "mov $0, %k[c]\n\t"
+                    "setc %b[c]\n\t"
+                    : [c] "+&r"(carry), [i] "+&c"(index)
+                    : [r] "r"(r + blocks), [a] "r"(a + blocks),
+                      [b] "r"(b + blocks)
+                    : "r9", "cc", "memory");
+            }
+            return addGroupsScalar(r + blocks, a + blocks, b + blocks,
+                                   n - blocks, carry);
+        }
+
+        __attribute__((target("bmi2,adx")))
+        inline uint64_t subGroupsAdx(uint64_t* r, const uint64_t* a,
+                                     const uint64_t* b, size_t n,
+                                     uint64_t borrow) {
+            auto blocks = n & ~size_t(3);
+            if (blocks) {
+                auto index = -static_cast<ptrdiff_t>(blocks);
+                asm volatile(
+                    "add $-1, %[c]\n\t"
+                    "1:\n\t"
+                    "mov (%[a],%[i],8), %%r9\n\t"
+                    "sbb (%[b],%[i],8), %%r9\n\t"
+                    "mov %%r9, (%[r],%[i],8)\n\t"
+                    "mov 8(%[a],%[i],8), %%r9\n\t"
+                    "sbb 8(%[b],%[i],8), %%r9\n\t"
+                    "mov %%r9, 8(%[r],%[i],8)\n\t"
+                    "mov 16(%[a],%[i],8), %%r9\n\t"
+                    "sbb 16(%[b],%[i],8), %%r9\n\t"
+                    "mov %%r9, 16(%[r],%[i],8)\n\t"
+                    "mov 24(%[a],%[i],8), %%r9\n\t"
+                    "sbb 24(%[b],%[i],8), %%r9\n\t"
+                    "mov %%r9, 24(%[r],%[i],8)\n\t"
+                    "lea 4(%[i]), %[i]\n\t"
+                    "jrcxz 2f\n\t"
+                    "jmp 1b\n"
+                    "2:\n\t"
+                    "mov $0, %k[c]\n\t"
+                    "setc %b[c]\n\t"
+                    : [c] "+&r"(borrow), [i] "+&c"(index)
+                    : [r] "r"(r + blocks), [a] "r"(a + blocks),
+                      [b] "r"(b + blocks)
+                    : "r9", "cc", "memory");
+            }
+            return subGroupsScalar(r + blocks, a + blocks, b + blocks,
+                                   n - blocks, borrow);
+        }
+#endif
+
+#if HAUSP_BIGINT_X86 && defined(__x86_64__)
+        constexpr uint64_t LIMB52_MASK = (uint64_t(1) << 52) - 1;
+        // 16 limbs of 52 bits span exactly 13 groups, so whole blocks of
+        // that size convert with fixed shifts
+        constexpr size_t LIMB52_BLOCK = 16;
+        constexpr size_t LIMB52_BLOCK_GROUPS = 13;
+        constexpr size_t IFMA_MIN_GROUPS = 16;
+
+        // Bits [52 k, 52 k + 52) of the n groups at x
+        inline uint64_t limb52(const uint64_t* x, size_t n, size_t k) {
+            auto bit = 52 * k;
+            auto word = bit / 64;
+            auto offset = bit % 64;
+            uint64_t value = word < n ? x[word] >> offset : 0;
+            if (offset > 12 && word + 1 < n) {
+                value |= x[word + 1] << (64 - offset);
+            }
+            return value & LIMB52_MASK;
+        }
+
+        // Carries the n columns of a product in radix 2^52 into limbs and
+        // packs them into the rn groups at r, returning the carry out.
+        inline uint64_t packLimbs52(const uint64_t* columns, size_t n,
+                                    uint64_t carry, uint64_t* r, size_t rn) {
+            std::fill(r, r + rn, 0);
+            #pragma GCC unroll 16
+            for (size_t k = 0; k < n; ++k) {
+                auto value = columns[k] + carry;
+                carry = value >> 52;
+                value &= LIMB52_MASK;
+                auto word = 52 * k / 64;
+                auto offset = 52 * k % 64;
+                if (word < rn) {
+                    r[word] |= value << offset;
+                }
+                if (offset > 12 && word + 1 < rn) {
+                    r[word + 1] |= value >> (64 - offset);
+                }
+            }
+            return carry;
+        }
+
+        // One limb of a against the K registers of b; see below
+        template<size_t K>
+        __attribute__((target("avx512f,avx512ifma"), always_inline))
+        inline uint64_t ifmaStep(__m512i* low, __m512i* high,
+                                 const __m512i* operand, uint64_t limb,
+                                 uint64_t& high_column) {
+            auto multiplier = _mm512_set1_epi64(limb);
+            #pragma GCC unroll 8
+            for (size_t k = 0; k < K; ++k) {
+                low[k] = _mm512_madd52lo_epu64(low[k], operand[k], multiplier);
+                high[k] = _mm512_madd52hi_epu64(high[k], operand[k],
+                                                multiplier);
+            }
+            // The all-ones masked forms compile to the plain instructions,
+            // without the undefined source operand that GCC warns about
+            uint64_t column = _mm_cvtsi128_si64(
+                _mm512_maskz_extracti32x4_epi32(0xf, low[0], 0));
+            column += high_column;
+            high_column = _mm_cvtsi128_si64(
+                _mm512_maskz_extracti32x4_epi32(0xf, high[0], 0));
+            const auto zero = _mm512_setzero_si512();
+            #pragma GCC unroll 8
+            for (size_t k = 0; k < K; ++k) {
+                auto next_low = k + 1 < K ? low[k + 1] : zero;
+                auto next_high = k + 1 < K ? high[k + 1] : zero;
+                low[k] = _mm512_maskz_alignr_epi64(0xff, next_low, low[k], 1);
+                high[k] = _mm512_maskz_alignr_epi64(0xff, next_high, high[k],
+                                                    1);
+            }
+            return column;
+        }
+
+        // Product with AVX-512 IFMA, over a redundant radix 2^52 form of
+        // the operands. b lives in K registers of eight 52-bit limbs; the
+        // limbs of a are streamed one at a time. The accumulators are two
+        // windows over the columns of the product: while the j-th limb of
+        // a is processed, lane i of low holds column i + j and gets the
+        // low halves of the products, lane i of high holds column i + j + 1
+        // and gets the high halves. Lane 0 of each is then complete, and
+        // both windows slide one lane; keeping them apart leaves two short
+        // dependency chains instead of one long one. A column adds at most
+        // 2 * 8 * K values below 2^52, so nothing overflows the 64-bit
+        // lanes. Completed columns are carried and packed into groups a
+        // block at a time.
+        template<size_t K>
+        __attribute__((target("avx512f,avx512ifma")))
+        void multGroupsIfmaBlocks(uint64_t* r, const uint64_t* a, size_t an,
+                                  const uint64_t* b, size_t bn) {
+            uint64_t limbs[8 * K];
+            for (size_t i = 0; i < 8 * K; ++i) {
+                limbs[i] = limb52(b, bn, i);
+            }
+            __m512i operand[K], low[K], high[K];
+            #pragma GCC unroll 8
+            for (size_t k = 0; k < K; ++k) {
+                operand[k] = _mm512_loadu_si512(limbs + 8 * k);
+                low[k] = _mm512_setzero_si512();
+                high[k] = _mm512_setzero_si512();
+            }
+
+            uint64_t columns[LIMB52_BLOCK + 8 * K];
+            uint64_t high_column = 0;
+            uint64_t carry = 0;
+            auto blocks = an / LIMB52_BLOCK_GROUPS;
+            for (size_t block = 0; block < blocks; ++block) {
+                auto groups = block * LIMB52_BLOCK_GROUPS;
+                for (size_t j = 0; j < LIMB52_BLOCK; ++j) {
+                    auto limb = limb52(a + groups, LIMB52_BLOCK_GROUPS, j);
+                    columns[j] = ifmaStep<K>(low, high, operand, limb,
+                                             high_column);
+                }
+                carry = packLimbs52(columns, LIMB52_BLOCK, carry, r + groups,
+                                    LIMB52_BLOCK_GROUPS);
+            }
+
+            // The groups of a left over, then the columns still in the
+            // windows
+            auto done = blocks * LIMB52_BLOCK_GROUPS;
+            auto rest = an - done;
+            auto rest_limbs = (64 * rest + 51) / 52;
+            for (size_t j = 0; j < rest_limbs; ++j) {
+                columns[j] = ifmaStep<K>(low, high, operand,
+                                         limb52(a + done, rest, j),
+                                         high_column);
+            }
+            uint64_t highs[8 * K];
+            #pragma GCC unroll 8
+            for (size_t k = 0; k < K; ++k) {
+                _mm512_storeu_si512(columns + rest_limbs + 8 * k, low[k]);
+                _mm512_storeu_si512(highs + 8 * k, high[k]);
+            }
+            for (size_t i = 0; i < 8 * K; ++i) {
+                columns[rest_limbs + i] += high_column;
+                high_column = highs[i];
+            }
+            packLimbs52(columns, rest_limbs + 8 * K, carry, r + done,
+                        an + bn - done);
+        }
+
+        // r[0..an+bn) = a[0..an) * b[0..bn), with an >= bn and r not
+        // overlapping the operands. Returns false, leaving r alone, when
+        // b is too short to repay the conversions to radix 2^52 or longer
+        // than the register blocks allow.
+        inline bool multGroupsIfma(uint64_t* r, const uint64_t* a, size_t an,
+                                   const uint64_t* b, size_t bn) {
+            if (bn < IFMA_MIN_GROUPS) {
+                return false;
+            }
+            switch ((64 * bn + 415) / 416) {
+                case 1: multGroupsIfmaBlocks<1>(r, a, an, b, bn); return true;
+                case 2: multGroupsIfmaBlocks<2>(r, a, an, b, bn); return true;
+                case 3: multGroupsIfmaBlocks<3>(r, a, an, b, bn); return true;
+                case 4: multGroupsIfmaBlocks<4>(r, a, an, b, bn); return true;
+                case 5: multGroupsIfmaBlocks<5>(r, a, an, b, bn); return true;
+                case 6: multGroupsIfmaBlocks<6>(r, a, an, b, bn); return true;
+                default: return false;
+            }
+        }
+#endif
+
+        // Shorter runs than this go straight to the portable loops, which
+        // is all the kernels would do with them anyway
+        constexpr size_t KERNEL_BLOCK = 4;
+
+        template<typename T>
+        using MulGroups1 = T (*)(T*, const T*, size_t, T, T);
+        template<typename T>
+        using AddGroups = T (*)(T*, const T*, const T*, size_t, T);
+        template<typename T>
+        using MultGroups = bool (*)(T*, const T*, size_t, const T*, size_t);
+        template<typename T>
+        using ShiftGroups = T (*)(T*, const T*, size_t, unsigned);
+
+        // The basecase kernels for groups of type T. mult is a vectorized
+        // schoolbook product, null where there is none.
+        template<typename T>
+        struct GroupKernels {
+            MulGroups1<T> mul1 = &mulGroups1Scalar<T>;
+            MulGroups1<T> addMul1 = &addMulGroups1Scalar<T>;
+            AddGroups<T> add = &addGroupsScalar<T>;
+            AddGroups<T> sub = &subGroupsScalar<T>;
+            MultGroups<T> mult = nullptr;
+            ShiftGroups<T> shiftLeft = &shiftLeftGroupsScalar<T>;
+            ShiftGroups<T> shiftRight = &shiftRightGroupsScalar<T>;
+        };
+
+        // Every hot kernel, for one CpuLevel
+        struct Kernels {
+            CpuLevel level = CpuLevel::SCALAR;
+            ParseFragments parseFragments = &parseFragmentsScalar;
+            FormatFragments formatFragments = &formatFragmentsScalar;
+            GroupKernels<uint32_t> groups32;
+#ifdef __SIZEOF_INT128__
+            GroupKernels<uint64_t> groups64;
+#endif
+        };
+
+        // The best level the running CPU supports
+        inline CpuLevel detectCpuLevel() {
+#if HAUSP_BIGINT_X86
+            __builtin_cpu_init();
+            if (!__builtin_cpu_supports("sse4.1")) {
+                return CpuLevel::SCALAR;
+            }
+            if (!__builtin_cpu_supports("avx2")) {
+                return CpuLevel::SSE41;
+            }
+            if (!__builtin_cpu_supports("bmi2")
+                || !__builtin_cpu_supports("adx")) {
+                return CpuLevel::AVX2;
+            }
+            if (!__builtin_cpu_supports("avx512f")
+                || !__builtin_cpu_supports("avx512ifma")) {
+                return CpuLevel::ADX;
+            }
+            return CpuLevel::AVX512;
+#else
+            return CpuLevel::SCALAR;
+#endif
+        }
+
+        // The level named by text, as in HAUSP_BIGINT_CPU, or fallback
+        // if it names none
+        inline CpuLevel parseCpuLevel(std::string_view text,
+                                      CpuLevel fallback) {
+            const std::pair<std::string_view, CpuLevel> names[] = {
+                {"scalar", CpuLevel::SCALAR}, {"sse4.1", CpuLevel::SSE41},
+                {"avx2", CpuLevel::AVX2}, {"adx", CpuLevel::ADX},
+                {"avx512", CpuLevel::AVX512},
+            };
+            for (auto& [name, level] : names) {
+                if (text == name) {
+                    return level;
+                }
+            }
+            return fallback;
+        }
+
+        // The kernels for level, which the CPU must support
+        inline Kernels selectKernels(CpuLevel level) {
+            Kernels result;
+            result.level = level;
+#if HAUSP_BIGINT_X86
+            if (level >= CpuLevel::SSE41) {
+                result.parseFragments = &parseFragmentsSse41;
+                result.formatFragments = &formatFragmentsSse41;
+            }
+            if (level >= CpuLevel::AVX2) {
+                result.parseFragments = &parseFragmentsAvx2;
+                result.formatFragments = &formatFragmentsAvx2;
+                result.groups32.shiftLeft = &shiftLeftGroupsAvx2<uint32_t>;
+                result.groups32.shiftRight = &shiftRightGroupsAvx2<uint32_t>;
+#ifdef __SIZEOF_INT128__
+                result.groups64.shiftLeft = &shiftLeftGroupsAvx2<uint64_t>;
+                result.groups64.shiftRight = &shiftRightGroupsAvx2<uint64_t>;
+#endif
+            }
+#if defined(__x86_64__)
+            if (level >= CpuLevel::ADX) {
+                result.groups64.mul1 = &mulGroups1Adx;
+                result.groups64.addMul1 = &addMulGroups1Adx;
+                result.groups64.add = &addGroupsAdx;
+                result.groups64.sub = &subGroupsAdx;
+            }
+            if (level >= CpuLevel::AVX512) {
+                result.groups64.mult = &multGroupsIfma;
+            }
+#endif
+#endif
+            return result;
+        }
+
+        // The kernels of this process, chosen on first use
+        inline const Kernels& kernels() {
+            static const auto table = [] {
+                auto level = detectCpuLevel();
+                if (auto forced = std::getenv("HAUSP_BIGINT_CPU")) {
+                    level = std::min(level, parseCpuLevel(forced, level));
+                }
+                return selectKernels(level);
+            }();
+            return table;
+        }
+
+        template<typename T>
+        const GroupKernels<T>& groupKernels() {
+            if constexpr (std::is_same<T, uint32_t>::value) {
+                return kernels().groups32;
+            } else {
+                return kernels().groups64;
+            }
+        }
+
+#if HAUSP_BIGINT_GROUP_BITS == 64
+        using DefaultGroup = uint64_t;
+#else
+        using DefaultGroup = uint32_t;
+#endif
+    }
+
+    // The level the kernels of this process were chosen for
+    inline CpuLevel cpuLevel() {
+        return detail::kernels().level;
+    }
+
+    class ScratchArena;
+
+    namespace detail {
+        template<typename T>
+        class ScratchAllocator;
+        class ScratchFrame;
+        class ScratchBypass;
+    }
+
+    // Monotonic arena for the temporaries of the multiplication, division
+    // and conversion algorithms. While a Scope is alive, the scratch
+    // buffers those algorithms need on its thread are carved out of the
+    // arena instead of the heap. Only the most recent allocation can be
+    // given back, which suits the nested temporaries of those algorithms;
+    // release() drops everything at once, keeping room for as much as was
+    // used so that the next round of work fits in a single block.
+    //
+    // Without a Scope, each thread uses an arena of its own that is
+    // released as every top-level operation ends, keeping its memory for
+    // the next one up to a few MiB. Loops over operands of tens of
+    // thousands of digits thus stop allocating scratch once warmed up.
+    class ScratchArena {
+        template<typename T>
+        friend class detail::ScratchAllocator;
+        friend class detail::ScratchFrame;
+        friend class detail::ScratchBypass;
      public:
-        BigInt() = default;
-        template<typename T, std::enable_if_t<std::is_unsigned<T>::value, int> = 0>
-        BigInt(T);
-        template<typename T, std::enable_if_t<std::is_signed<T>::value, int> = 0>
-        BigInt(T);
-
-        static BigInt fromString(const std::string&);
-        BigInt& operator+=(const BigInt&);
-        BigInt& operator-=(const BigInt&);
-        BigInt operator-() const;
-        BigInt& operator*=(const BigInt&);
-        BigInt& operator<<=(intmax_t);
-        BigInt& operator>>=(intmax_t);
+        // Makes arena the source of scratch memory of the current thread
+        // for as long as it lives. Scopes may be nested.
+        class Scope {
+         public:
+            explicit Scope(ScratchArena& arena): previous{active()} {
+                active() = &arena;
+            }
+            ~Scope() { active() = previous; }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+         private:
+            ScratchArena* previous;
+        };
+
+        explicit ScratchArena(size_t block_size = size_t(1) << 16):
+         block_size{block_size} { }
+        ScratchArena(const ScratchArena&) = delete;
+        ScratchArena& operator=(const ScratchArena&) = delete;
+        ~ScratchArena();
+
+        void* allocate(size_t);
+        void release();
+        // Most memory held at once since the last release
+        size_t used() const { return peak_bytes; }
+
+        // The arena of the innermost Scope of this thread, if any
+        static ScratchArena* current() { return active(); }
+
      private:
-        bool signal = POSITIVE;
-        GroupVector data = {0};
+        struct Block {
+            Block* next;
+            size_t size;
+        };
+        static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+        static constexpr size_t HEADER =
+            (sizeof(Block) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
 
-        template<typename Operation>
-        DoubleGroup carryOn(const BigInt&, DoubleGroup, const Operation&);
-        void add(const BigInt&);
-        void sub(const BigInt&);
-        void longMult(const BigInt&);
-        void shrink();
+        // Initial block size and most memory kept between operations by
+        // the arena of a thread
+        static constexpr size_t LOCAL_BLOCK_BYTES = size_t(1) << 12;
+        static constexpr size_t RETAINED_BYTES = size_t(1) << 22;
+
+        Block* blocks = nullptr;
+        char* cursor = nullptr;
+        char* limit = nullptr;
+        size_t used_bytes = 0;
+        size_t peak_bytes = 0;
+        size_t block_size;
+
+        void addBlock(size_t);
+        void reclaim(void*, size_t);
+        void purge();
+        size_t retained() const;
+        static ScratchArena*& active();
+        static ScratchArena& local();
+        static size_t& depth();
+        static bool& bypassed();
+        static ScratchArena* scratch();
+    };
+
+    inline ScratchArena::~ScratchArena() {
+        purge();
+    }
+
+    inline void* ScratchArena::allocate(size_t bytes) {
+        bytes = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        if (size_t(limit - cursor) < bytes) {
+            // Blocks at least double, so that large operations only
+            // take a few of them
+            addBlock(std::max({block_size, bytes + HEADER,
+                               blocks ? 2 * blocks->size : 0}));
+        }
+        auto memory = cursor;
+        cursor += bytes;
+        used_bytes += bytes;
+        peak_bytes = std::max(peak_bytes, used_bytes);
+        return memory;
+    }
+
+    inline void ScratchArena::addBlock(size_t size) {
+        auto block = static_cast<Block*>(::operator new(size));
+        block->next = blocks;
+        block->size = size;
+        blocks = block;
+        cursor = reinterpret_cast<char*>(block) + HEADER;
+        limit = reinterpret_cast<char*>(block) + size;
+    }
+
+    // Takes memory back if it is the last allocation of the block in use
+    inline void ScratchArena::reclaim(void* memory, size_t bytes) {
+        bytes = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        if (static_cast<char*>(memory) + bytes == cursor) {
+            cursor -= bytes;
+            used_bytes -= bytes;
+        }
+    }
+
+    // A single block is kept as it is. Several are merged: they are all
+    // freed and replaced right away by one that holds the most memory
+    // used at once, so the next round of work fits in it.
+    inline void ScratchArena::release() {
+        if (blocks && blocks->next) {
+            auto size = retained();
+            purge();
+            block_size = size;
+            addBlock(block_size);
+        } else if (blocks) {
+            cursor = reinterpret_cast<char*>(blocks) + HEADER;
+        }
+        used_bytes = peak_bytes = 0;
+    }
+
+    inline void ScratchArena::purge() {
+        while (blocks) {
+            auto next = blocks->next;
+            ::operator delete(blocks);
+            blocks = next;
+        }
+        cursor = limit = nullptr;
+        used_bytes = peak_bytes = 0;
+    }
+
+    // Size of the block release() keeps. A single block gives back no
+    // more than several, as only the block in use can reclaim memory.
+    inline size_t ScratchArena::retained() const {
+        if (!blocks) {
+            return 0;
+        }
+        if (!blocks->next) {
+            return blocks->size;
+        }
+        return std::max(block_size, peak_bytes + HEADER);
+    }
+
+    inline ScratchArena*& ScratchArena::active() {
+        thread_local ScratchArena* arena = nullptr;
+        return arena;
+    }
+
+    inline ScratchArena& ScratchArena::local() {
+        thread_local ScratchArena arena(LOCAL_BLOCK_BYTES);
+        return arena;
+    }
+
+    inline size_t& ScratchArena::depth() {
+        thread_local size_t depth = 0;
+        return depth;
+    }
+
+    inline bool& ScratchArena::bypassed() {
+        thread_local bool bypassed = false;
+        return bypassed;
+    }
+
+    // Where scratch memory comes from: the innermost Scope, the arena of
+    // the thread during an operation, or else the heap.
+    inline ScratchArena* ScratchArena::scratch() {
+        if (bypassed()) {
+            return nullptr;
+        }
+        if (auto arena = active()) {
+            return arena;
+        }
+        return depth() > 0 ? &local() : nullptr;
+    }
+
+    namespace detail {
+        // Spans a top-level operation of the library: scratch buffers
+        // allocated meanwhile may come from the arena of the thread,
+        // which is released when the outermost frame closes. They must
+        // not outlive the frame.
+        class ScratchFrame {
+         public:
+            ScratchFrame() { ++ScratchArena::depth(); }
+            ~ScratchFrame();
+            ScratchFrame(const ScratchFrame&) = delete;
+            ScratchFrame& operator=(const ScratchFrame&) = delete;
+        };
+
+        inline ScratchFrame::~ScratchFrame() {
+            if (--ScratchArena::depth() == 0) {
+                auto& arena = ScratchArena::local();
+                if (arena.retained() > ScratchArena::RETAINED_BYTES) {
+                    arena.purge();
+                    arena.block_size = ScratchArena::LOCAL_BLOCK_BYTES;
+                } else {
+                    arena.release();
+                }
+            }
+        }
+
+        // Sends the scratch allocations of the thread to the heap while it
+        // lives, if enabled, for values that must outlive the operation.
+        class ScratchBypass {
+         public:
+            explicit ScratchBypass(bool enabled):
+             previous{ScratchArena::bypassed()} {
+                ScratchArena::bypassed() = previous || enabled;
+            }
+            ~ScratchBypass() { ScratchArena::bypassed() = previous; }
+            ScratchBypass(const ScratchBypass&) = delete;
+            ScratchBypass& operator=(const ScratchBypass&) = delete;
+
+         private:
+            bool previous;
+        };
+
+        // Allocates from the current scratch arena, if there is one, and
+        // from the heap otherwise. Each allocation is preceded by a header
+        // telling which arena, if any, so that it can be freed from
+        // anywhere.
+        template<typename T>
+        class ScratchAllocator {
+         public:
+            using value_type = T;
+
+            ScratchAllocator() = default;
+            template<typename U>
+            ScratchAllocator(const ScratchAllocator<U>&) { }
+
+            T* allocate(size_t);
+            void deallocate(T*, size_t);
+
+            friend bool operator==(const ScratchAllocator&,
+                                   const ScratchAllocator&) {
+                return true;
+            }
+            friend bool operator!=(const ScratchAllocator&,
+                                   const ScratchAllocator&) {
+                return false;
+            }
+
+         private:
+            static constexpr size_t HEADER = alignof(std::max_align_t);
+        };
+
+        template<typename T>
+        T* ScratchAllocator<T>::allocate(size_t count) {
+            auto bytes = count * sizeof(T) + HEADER;
+            auto arena = ScratchArena::scratch();
+            auto memory = static_cast<char*>(
+                arena ? arena->allocate(bytes) : ::operator new(bytes));
+            new (memory) ScratchArena*(arena);
+            return reinterpret_cast<T*>(memory + HEADER);
+        }
+
+        template<typename T>
+        void ScratchAllocator<T>::deallocate(T* groups, size_t count) {
+            auto memory = reinterpret_cast<char*>(groups) - HEADER;
+            if (auto arena = *reinterpret_cast<ScratchArena**>(memory)) {
+                arena->reclaim(memory, count * sizeof(T) + HEADER);
+            } else {
+                ::operator delete(memory);
+            }
+        }
+    }
+
+    namespace detail {
+        // Operand sizes, in groups, at which the algorithms switch over.
+        // Group counts; wide groups push the NTT crossover out because
+        // its transform still works on 32-bit pieces.
+        template<typename Limb>
+        struct Thresholds {
+            static constexpr auto WIDE =
+                std::numeric_limits<Limb>::digits == 64;
+            size_t karatsuba = 32;
+            size_t toom3 = WIDE ? 120 : 200;
+            size_t toom4 = WIDE ? 400 : 500;
+            size_t ntt = WIDE ? 12000 : 2500;
+            size_t burnikelZiegler = 80;
+            size_t newton = 60000;
+            size_t radixConversion = 64;
+        };
+    }
+
+    // Arbitrary-precision integer stored as the sign and the magnitude,
+    // the latter in groups of type Limb obtained from Allocator.
+    template<typename Limb = detail::DefaultGroup,
+             typename Allocator = std::allocator<Limb>>
+    class BasicBigInt;
+
+    using BigInt = BasicBigInt<>;
+
+    template<typename Limb, typename Allocator>
+    std::to_chars_result to_chars(char*, char*,
+                                  const BasicBigInt<Limb, Allocator>&,
+                                  int = 10);
+    template<typename Limb, typename Allocator>
+    std::from_chars_result from_chars(const char*, const char*,
+                                      BasicBigInt<Limb, Allocator>&, int = 10);
+
+    template<typename Limb, typename Allocator>
+    class BasicBigInt {
+        // Other instantiations use the scratch one for their temporaries
+        template<typename L, typename A>
+        friend class BasicBigInt;
+        // Friend non-member operators
+        template<typename L, typename A>
+        friend std::ostream& operator<<(std::ostream&, const BasicBigInt<L, A>&);
+        template<typename L, typename A>
+        friend bool operator==(const BasicBigInt<L, A>&,
+                               const BasicBigInt<L, A>&);
+        template<typename L, typename A>
+        friend bool operator<(const BasicBigInt<L, A>&,
+                              const BasicBigInt<L, A>&);
+        template<typename L, typename A>
+        friend BasicBigInt<L, A> operator-(const BasicBigInt<L, A>&,
+                                           BasicBigInt<L, A>&&);
+        template<typename L, typename A>
+        friend BasicBigInt<L, A> operator*(const BasicBigInt<L, A>&,
+                                           const BasicBigInt<L, A>&);
+        template<typename L, typename A>
+        friend std::pair<BasicBigInt<L, A>, BasicBigInt<L, A>>
+        divmod(const BasicBigInt<L, A>&, const BasicBigInt<L, A>&);
+        template<typename L, typename A>
+        friend std::to_chars_result to_chars(char*, char*,
+                                             const BasicBigInt<L, A>&, int);
+        template<typename L, typename A>
+        friend std::from_chars_result from_chars(const char*, const char*,
+                                                 BasicBigInt<L, A>&, int);
+        static_assert(std::is_same<Limb, uint32_t>::value
+                      || std::is_same<Limb, uint64_t>::value,
+                      "BasicBigInt groups are either 32 or 64 bits wide");
+        // Aliases
+        using Group = Limb;
+        using DoubleGroup = typename detail::DoubleWidth<Limb>::type;
+        // Constant values
+        static constexpr auto GROUP_MAX = std::numeric_limits<Group>::max();
+        static constexpr auto GROUP_BIT_SIZE = std::numeric_limits<Group>::digits;
+        static constexpr auto GROUP_RADIX = DoubleGroup(1) << GROUP_BIT_SIZE;
+        // Largest power of ten made of whole 9-digit fragments, the unit
+        // of the digit kernels, that fits in a group, and its exponent
+        static constexpr size_t DECIMAL_DIGITS = 9 * (GROUP_BIT_SIZE / 32);
+        static constexpr Group DECIMAL_RADIX =
+            GROUP_BIT_SIZE == 64 ? Group(1000000000000000000ull) : 1000000000;
+        // Numbers up to this size are converted in stack buffers
+        static constexpr size_t SMALL_CONVERSION_GROUPS = 64;
+        // Digits of the radices 2 to 36, in the same order
+        static constexpr const char* DIGIT_CHARS =
+            "0123456789abcdefghijklmnopqrstuvwxyz";
+        static constexpr size_t INLINE_GROUPS = 128 / GROUP_BIT_SIZE;
+        using GroupAllocator = typename std::allocator_traits<
+            Allocator>::template rebind_alloc<Group>;
+        using GroupVector =
+            detail::GroupBuffer<Group, INLINE_GROUPS, GroupAllocator>;
+        // Temporaries of the algorithms, drawn from the scratch arena
+        using ScratchVector = detail::GroupBuffer<Group, INLINE_GROUPS,
+            detail::ScratchAllocator<Group>>;
+        using NttVector =
+            std::vector<uint32_t, detail::ScratchAllocator<uint32_t>>;
+        // Intermediate values of the Toom, division and radix conversion
+        // algorithms. Those algorithms are only run in this instantiation,
+        // whatever the allocator of the operands.
+        using Scratch = BasicBigInt<Limb, detail::ScratchAllocator<Limb>>;
+        // Whether the powers of the radix conversions may be kept in the
+        // process-wide cache. Stateful allocators may not outlive it, so
+        // their conversions build the powers they need each time instead.
+        static constexpr bool SHARED_POWERS =
+            std::allocator_traits<Allocator>::is_always_equal::value;
+        // Transform lengths, in 32-bit pieces, the NTT primes support
+        static constexpr size_t NTT_MAX_LENGTH = size_t(1) << 24;
+        static constexpr auto POSITIVE = false;
+        static constexpr auto NEGATIVE = true;
+     public:
+        // Crossover sizes of the algorithms, shared by every allocator of
+        // the same group type. Meant to be tuned once at startup, before
+        // any concurrent use.
+        using Thresholds = detail::Thresholds<Limb>;
+
+        using allocator_type = Allocator;
+
+        BasicBigInt() = default;
+        explicit BasicBigInt(const Allocator&);
+        template<typename T, std::enable_if_t<std::is_unsigned<T>::value, int> = 0>
+        BasicBigInt(T, const Allocator& = Allocator());
+        template<typename T, std::enable_if_t<std::is_signed<T>::value, int> = 0>
+        BasicBigInt(T, const Allocator& = Allocator());
+        BasicBigInt(const BasicBigInt&) = default;
+        BasicBigInt(const BasicBigInt&, const Allocator&);
+        BasicBigInt(BasicBigInt&&) = default;
+        BasicBigInt(BasicBigInt&&, const Allocator&);
+        BasicBigInt& operator=(const BasicBigInt&) = default;
+        BasicBigInt& operator=(BasicBigInt&&) = default;
+
+        static BasicBigInt fromString(std::string_view, int = 10,
+                                      const Allocator& = Allocator());
+        Allocator get_allocator() const;
+        BasicBigInt& operator+=(const BasicBigInt&);
+        BasicBigInt& operator-=(const BasicBigInt&);
+        BasicBigInt operator-() const&;
+        BasicBigInt operator-() &&;
+        BasicBigInt& operator*=(const BasicBigInt&);
+        BasicBigInt& operator/=(const BasicBigInt&);
+        BasicBigInt& operator%=(const BasicBigInt&);
+        BasicBigInt& operator<<=(intmax_t);
+
+        template<typename T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+        BasicBigInt& operator+=(T);
+        template<typename T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+        BasicBigInt& operator-=(T);
+        template<typename T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+        BasicBigInt& operator*=(T);
+        template<typename T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+        BasicBigInt& operator/=(T);
+        template<typename T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+        BasicBigInt& operator%=(T);
+        BasicBigInt& operator>>=(intmax_t);
+        BasicBigInt& square();
+
+        static Thresholds& thresholds();
+        static void prewarmPowers(size_t, int = 10);
+     private:
+        bool signal = POSITIVE;
+        GroupVector data = {0};
+
+        void add(const BasicBigInt&);
+        void sub(const BasicBigInt&);
+        void mult(const BasicBigInt&, const BasicBigInt&);
+        void divide(const BasicBigInt&, BasicBigInt*);
+        void shrink();
+        bool isZero() const;
+        void divExact(Group);
+        void addSmall(bool, uintmax_t);
+        void mulSmall(bool, uintmax_t);
+        uintmax_t divSmall(bool, uintmax_t);
+
+        ScratchVector toRadix(Group) const;
+        size_t bitLength() const;
+
+        // Pointers to radix^(2^k), into the shared cache or into the
+        // powers owned by the table itself
+        struct PowerTable : std::vector<
+            const Scratch*, detail::ScratchAllocator<const Scratch*>> {
+            std::deque<Scratch, detail::ScratchAllocator<Scratch>> owned;
+        };
+        static PowerTable radixPowers(Group, size_t, bool);
+        static void toRadix(Scratch, const PowerTable&, size_t, Group*, Group);
+        static Scratch fromRadix(const Group*, size_t, const PowerTable&,
+                                 size_t, Group);
+        static GroupVector convertBase(uintmax_t, const GroupAllocator&);
+        static void readDigits(std::string_view, int, GroupVector&);
+        static void readBits(std::string_view, int, GroupVector&);
+        static void parseDecimal(const char*, size_t, Group*);
+        static void formatDecimal(const Group*, size_t, char*);
+        static unsigned digitValue(char);
+        static size_t groupDigits(int);
+        static Group groupRadix(int);
+        static int powerOfTwo(int);
+        static Group addGroups(Group*, const Group*, size_t,
+                               const Group*, size_t);
+        static Group subGroups(Group*, const Group*, size_t,
+                               const Group*, size_t);
+        static int compareGroups(const Group*, size_t, const Group*, size_t);
+        static void multGroups(Group*, const Group*, size_t,
+                               const Group*, size_t);
+        static void longMult(Group*, const Group*, size_t,
+                             const Group*, size_t);
+        static void squareGroups(Group*, const Group*, size_t);
+        static void longSquare(Group*, const Group*, size_t);
+        static void karatsubaSquare(Group*, const Group*, size_t);
+        static void karatsubaMult(Group*, const Group*, const Group*, size_t);
+        static void toom32Mult(Group*, const Group*, size_t,
+                               const Group*, size_t);
+        static void toom3Mult(Group*, const Group*, size_t,
+                              const Group*, size_t);
+        static void toom4Mult(Group*, const Group*, size_t,
+                              const Group*, size_t);
+        static void nttMult(Group*, const Group*, size_t,
+                            const Group*, size_t);
+        template<uint32_t Modulus, uint32_t Root>
+        static void nttConvolution(NttVector&, const NttVector*);
+        template<uint32_t Modulus, uint32_t Root>
+        static void ntt(NttVector&, bool);
+        static uint32_t powMod(uint64_t, uint64_t, uint32_t);
+        static Group mulGroups1(Group*, const Group*, size_t, Group);
+        static Group addMulGroups1(Group*, const Group*, size_t, Group);
+        static Group divGroups1(Group*, const Group*, size_t, Group);
+        static uintmax_t divGroupsWide(Group*, const Group*, size_t, uintmax_t);
+        static Group subMulGroups1(Group*, const Group*, size_t, Group);
+        static void divGroups(Group*, Group*, const Group*, size_t,
+                              const Group*, size_t);
+        static void knuthDiv(Group*, Group*, size_t, const Group*, size_t);
+        static void divLarge(const Group*, size_t, const Group*, size_t,
+                             ScratchVector&, ScratchVector&);
+        static Scratch divSchoolbook(Scratch&, const Scratch&);
+        static Scratch div2n1n(Scratch&, const Scratch&, size_t);
+        static Scratch div3n2n(Scratch&, const Scratch&, const Scratch&,
+                               const Scratch&, const Scratch&, size_t);
+        static Scratch divBarrett(Scratch&, const Scratch&, const Scratch&,
+                                  size_t);
+        static Scratch reciprocal(const Scratch&, size_t);
+        static int leadingZeros(Group);
+
+        template<typename T>
+        static uintmax_t magnitude(T);
+        static Scratch fromGroups(const Group*, size_t, size_t, size_t);
+        static void addInto(Group*, size_t, size_t, const Scratch&);
+    };
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>::BasicBigInt(const Allocator& allocator):
+     data(1, 0, GroupAllocator(allocator)) { }
+
+    template<typename Limb, typename Allocator>
+    template<typename T, std::enable_if_t<std::is_unsigned<T>::value, int>>
+    BasicBigInt<Limb, Allocator>::BasicBigInt(T value,
+                                              const Allocator& allocator):
+     data{convertBase(value, GroupAllocator(allocator))} { }
+
+    template<typename Limb, typename Allocator>
+    template<typename T, std::enable_if_t<std::is_signed<T>::value, int>>
+    BasicBigInt<Limb, Allocator>::BasicBigInt(T value,
+                                              const Allocator& allocator):
+     signal{value < 0},
+     data{convertBase(magnitude(value), GroupAllocator(allocator))} { }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>::BasicBigInt(const BasicBigInt& other,
+                                              const Allocator& allocator):
+     signal{other.signal}, data(other.data, GroupAllocator(allocator)) { }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>::BasicBigInt(BasicBigInt&& other,
+                                              const Allocator& allocator):
+     signal{other.signal},
+     data(std::move(other.data), GroupAllocator(allocator)) { }
+
+    template<typename Limb, typename Allocator>
+    Allocator BasicBigInt<Limb, Allocator>::get_allocator() const {
+        return Allocator(data.get_allocator());
+    }
+
+    template<typename Limb, typename Allocator>
+    template<typename T>
+    uintmax_t BasicBigInt<Limb, Allocator>::magnitude(T value) {
+        if (std::is_signed<T>::value && value < 0) {
+            return uintmax_t(0) - uintmax_t(value);
+        }
+        return value;
+    }
+
+    template<typename Limb, typename Allocator>
+    template<typename T, std::enable_if_t<std::is_integral<T>::value, int>>
+    BasicBigInt<Limb, Allocator>&
+    BasicBigInt<Limb, Allocator>::operator+=(T value) {
+        addSmall(std::is_signed<T>::value && value < 0, magnitude(value));
+        return *this;
+    }
+
+    template<typename Limb, typename Allocator>
+    template<typename T, std::enable_if_t<std::is_integral<T>::value, int>>
+    BasicBigInt<Limb, Allocator>&
+    BasicBigInt<Limb, Allocator>::operator-=(T value) {
+        addSmall(!(std::is_signed<T>::value && value < 0), magnitude(value));
+        return *this;
+    }
+
+    template<typename Limb, typename Allocator>
+    template<typename T, std::enable_if_t<std::is_integral<T>::value, int>>
+    BasicBigInt<Limb, Allocator>&
+    BasicBigInt<Limb, Allocator>::operator*=(T value) {
+        mulSmall(std::is_signed<T>::value && value < 0, magnitude(value));
+        return *this;
+    }
+
+    template<typename Limb, typename Allocator>
+    template<typename T, std::enable_if_t<std::is_integral<T>::value, int>>
+    BasicBigInt<Limb, Allocator>&
+    BasicBigInt<Limb, Allocator>::operator/=(T value) {
+        divSmall(std::is_signed<T>::value && value < 0, magnitude(value));
+        return *this;
+    }
+
+    template<typename Limb, typename Allocator>
+    template<typename T, std::enable_if_t<std::is_integral<T>::value, int>>
+    BasicBigInt<Limb, Allocator>&
+    BasicBigInt<Limb, Allocator>::operator%=(T value) {
+        auto sign = signal;
+        auto remainder = divSmall(std::is_signed<T>::value && value < 0,
+                                  magnitude(value));
+        data = convertBase(remainder, data.get_allocator());
+        signal = remainder != 0 && sign;
+        return *this;
+    }
+
+    // Accepts optional surrounding whitespace, an optional sign (which
+    // may also be followed by whitespace) and at least one digit of the
+    // given base, from 2 to 36. Letters are case insensitive.
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    BasicBigInt<Limb, Allocator>::fromString(std::string_view str_value,
+                                             int base,
+                                             const Allocator& allocator) {
+        if (base < 2 || base > 36) {
+            throw std::runtime_error(
+                "Could not create BigInt from string: invalid base"
+            );
+        }
+        auto is_space = [](char c) {
+            return std::isspace(static_cast<unsigned char>(c)) != 0;
+        };
+        auto is_digit = [base](char c) {
+            return digitValue(c) < unsigned(base);
+        };
+        auto it = str_value.begin();
+        auto end = str_value.end();
+        it = std::find_if_not(it, end, is_space);
+        auto negative = it != end && *it == '-';
+        if (it != end && (*it == '+' || *it == '-')) {
+            it = std::find_if_not(it + 1, end, is_space);
+        }
+        auto digits_begin = it;
+        it = std::find_if_not(it, end, is_digit);
+        auto digits_end = it;
+        it = std::find_if_not(it, end, is_space);
+        if (digits_begin == digits_end || it != end) {
+            throw std::runtime_error(
+                "Could not create BigInt from string: non-integer value"
+            );
+        }
+        BasicBigInt integer(allocator);
+        readDigits(str_value.substr(digits_begin - str_value.begin(),
+                                    digits_end - digits_begin),
+                   base, integer.data);
+        integer.signal = negative;
+        integer.shrink();
+        if (integer.isZero()) {
+            integer.signal = POSITIVE;
+        }
+        return integer;
+    }
+
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::GroupVector
+    BasicBigInt<Limb, Allocator>::convertBase(uintmax_t value,
+                                              const GroupAllocator& allocator) {
+        GroupVector data(allocator);
+        if (value != 0) {
+            while (value > 0) {
+                data.emplace_back(value & GROUP_MAX);
+                // In two steps, as a group may be as wide as the value
+                value >>= GROUP_BIT_SIZE / 2;
+                value >>= GROUP_BIT_SIZE / 2;
+            }
+        } else {
+            data.emplace_back(0);
+        }
+        return data;
+    }
+
+    // Decimal groups of DECIMAL_DIGITS digits, least significant first,
+    // through the 9-digit fragment kernels. Wide groups hold two fragments.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::parseDecimal(const char* text,
+                                                    size_t count,
+                                                    Group* groups) {
+        constexpr size_t PER_GROUP = DECIMAL_DIGITS / 9;
+        if (PER_GROUP == 1) {
+            detail::kernels().parseFragments(
+                text, count, reinterpret_cast<uint32_t*>(groups));
+            return;
+        }
+        uint32_t fragments[16 * PER_GROUP];
+        while (count > 0) {
+            auto length = std::min(count, size_t(16));
+            detail::kernels().parseFragments(text, length * PER_GROUP,
+                                             fragments);
+            for (size_t i = 0; i < length; ++i) {
+                Group value = 0;
+                for (size_t j = PER_GROUP; j > 0; --j) {
+                    value = value * 1000000000 + fragments[i * PER_GROUP + j - 1];
+                }
+                groups[count - length + i] = value;
+            }
+            text += length * DECIMAL_DIGITS;
+            count -= length;
+        }
+    }
+
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::formatDecimal(const Group* groups,
+                                                     size_t count, char* text) {
+        constexpr size_t PER_GROUP = DECIMAL_DIGITS / 9;
+        if (PER_GROUP == 1) {
+            detail::kernels().formatFragments(
+                reinterpret_cast<const uint32_t*>(groups), count, text);
+            return;
+        }
+        uint32_t fragments[16 * PER_GROUP];
+        while (count > 0) {
+            auto length = std::min(count, size_t(16));
+            for (size_t i = 0; i < length; ++i) {
+                auto value = groups[count - length + i];
+                for (size_t j = 0; j < PER_GROUP; ++j) {
+                    fragments[i * PER_GROUP + j] = value % 1000000000;
+                    value /= 1000000000;
+                }
+            }
+            detail::kernels().formatFragments(fragments, length * PER_GROUP,
+                                              text);
+            text += length * DECIMAL_DIGITS;
+            count -= length;
+        }
+    }
+
+    // The value of a digit character in radices up to 36, or 36 or more
+    // if it is not a digit at all.
+    template<typename Limb, typename Allocator>
+    unsigned BasicBigInt<Limb, Allocator>::digitValue(char c) {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'z') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'Z') {
+            return c - 'A' + 10;
+        }
+        return 36;
+    }
+
+    // How many digits of the base fit in a group, and their radix
+    template<typename Limb, typename Allocator>
+    size_t BasicBigInt<Limb, Allocator>::groupDigits(int base) {
+        if (base == 10) {
+            return DECIMAL_DIGITS;
+        }
+        size_t count = 1;
+        for (DoubleGroup radix = base; radix * base <= GROUP_MAX; radix *= base) {
+            ++count;
+        }
+        return count;
+    }
+
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Group
+    BasicBigInt<Limb, Allocator>::groupRadix(int base) {
+        Group radix = 1;
+        for (auto count = groupDigits(base); count > 0; --count) {
+            radix *= base;
+        }
+        return radix;
+    }
+
+    // log2(base) for powers of two, 0 otherwise
+    template<typename Limb, typename Allocator>
+    int BasicBigInt<Limb, Allocator>::powerOfTwo(int base) {
+        if (base & (base - 1)) {
+            return 0;
+        }
+        auto bits = 0;
+        while (base > 1) {
+            base >>= 1;
+            ++bits;
+        }
+        return bits;
+    }
+
+    template<typename Limb, typename Allocator>
+    size_t BasicBigInt<Limb, Allocator>::bitLength() const {
+        auto top = data.back();
+        size_t bits = (data.size() - 1) * GROUP_BIT_SIZE;
+        while (top > 0) {
+            ++bits;
+            top >>= 1;
+        }
+        return bits;
+    }
+
+    // Reads a run of digits of the base into data. Powers of two are
+    // packed bit by bit; numbers small enough for Horner's rule are built
+    // in place, reusing the storage of data; larger ones are joined by
+    // divide and conquer in scratch storage and copied into data.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::readDigits(std::string_view digits,
+                                                  int base, GroupVector& data) {
+        if (powerOfTwo(base)) {
+            readBits(digits, powerOfTwo(base), data);
+            return;
+        }
+        auto size = digits.size();
+        auto digits_per_group = groupDigits(base);
+        auto radix = groupRadix(base);
+        auto count = (size + digits_per_group - 1) / digits_per_group;
+        auto head = count > 0 ? size - (count - 1) * digits_per_group : 0;
+        auto readFragment = [&](size_t begin, size_t length) {
+            Group fragment = 0;
+            for (auto i = begin; i < begin + length; ++i) {
+                fragment = fragment * base + digitValue(digits[i]);
+            }
+            return fragment;
+        };
+        // Full fragments, least significant first, with the digit kernels
+        // when decimal
+        auto readFragments = [&](size_t begin, size_t length, Group* out) {
+            if (base == 10) {
+                parseDecimal(digits.data() + begin, length, out);
+                return;
+            }
+            for (size_t i = length; i > 0; --i) {
+                out[i - 1] = readFragment(begin, digits_per_group);
+                begin += digits_per_group;
+            }
+        };
+
+        if (count <= std::max(thresholds().radixConversion, size_t(2))) {
+            // The digits bound the value by at most one group too many,
+            // unlike the fragments, so storage that already held a value
+            // of this size is reused rather than grown
+            auto groups = size_t(size * std::log2(base) / GROUP_BIT_SIZE) + 1;
+            if (groups > data.capacity() + 1) {
+                data.reserve(groups);
+            }
+            data.resize(1);
+            data[0] = 0;
+            auto push = [&](Group fragment, Group scale) {
+                auto n = data.size();
+                auto carry = mulGroups1(data.data(), data.data(), n, scale);
+                carry += addGroups(data.data(), data.data(), n, &fragment, 1);
+                if (carry > 0) {
+                    data.push_back(carry);
+                }
+            };
+            Group scale = 1;
+            for (size_t i = 0; i < head; ++i) {
+                scale *= base;
+            }
+            if (size > 0) {
+                push(readFragment(0, head), scale);
+            }
+            Group batch[16];
+            for (auto begin = head; begin < size; ) {
+                auto length = std::min((size - begin) / digits_per_group,
+                                       size_t(16));
+                readFragments(begin, length, batch);
+                for (size_t i = length; i > 0; --i) {
+                    push(batch[i - 1], radix);
+                }
+                begin += length * digits_per_group;
+            }
+            return;
+        }
+        detail::ScratchFrame frame;
+        auto fragments = ScratchVector(count, 0);
+        readFragments(head, count - 1, fragments.data());
+        fragments[count - 1] = readFragment(0, head);
+        auto powers = Scratch::radixPowers(radix, count, SHARED_POWERS);
+        auto value = Scratch::fromRadix(fragments.data(), count, powers,
+                                        powers.size() - 1, radix);
+        data.assign(value.data.begin(), value.data.end());
+    }
+
+    // Packs digits of bits bits each, from the least significant end
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::readBits(std::string_view digits,
+                                                int bits, GroupVector& data) {
+        auto total = digits.size() * bits;
+        data.resize(std::max((total + GROUP_BIT_SIZE - 1) / GROUP_BIT_SIZE,
+                             size_t(1)));
+        std::fill(data.begin(), data.end(), 0);
+        size_t position = 0;
+        for (auto i = digits.size(); i > 0; --i) {
+            Group value = digitValue(digits[i - 1]);
+            auto index = position / GROUP_BIT_SIZE;
+            auto offset = position % GROUP_BIT_SIZE;
+            data[index] |= value << offset;
+            if (offset + bits > GROUP_BIT_SIZE) {
+                data[index + 1] |= value >> (GROUP_BIT_SIZE - offset);
+            }
+            position += bits;
+        }
+        auto n = data.size();
+        while (n > 1 && data[n - 1] == 0) {
+            --n;
+        }
+        data.resize(n);
+    }
+
+    // The value of count <= 2^(level + 1) digits in the given radix,
+    // least significant first, joining halves with powers[level] until
+    // the pieces are small enough for Horner's rule.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Scratch
+    BasicBigInt<Limb, Allocator>::fromRadix(const Group* digits, size_t count,
+                                            const PowerTable& powers,
+                                            size_t level, Group radix) {
+        Scratch value;
+        if (count <= std::max(thresholds().radixConversion, size_t(2))) {
+            value.data.resize(count);
+            size_t n = 1;
+            for (size_t i = count; i > 0; --i) {
+                auto carry = mulGroups1(value.data.data(), value.data.data(),
+                                        n, radix);
+                carry += addGroups(value.data.data(), value.data.data(), n,
+                                   digits + i - 1, 1);
+                if (carry > 0) {
+                    value.data[n++] = carry;
+                }
+            }
+            value.data.resize(n);
+            value.shrink();
+            return value;
+        }
+        auto half = size_t(1) << level;
+        while (count <= half) {
+            half /= 2;
+            --level;
+        }
+        value = fromRadix(digits + half, count - half, powers, level - 1, radix);
+        value *= *powers[level];
+        value += fromRadix(digits, half, powers, level - 1, radix);
+        return value;
+    }
+
+    // The digits of the magnitude in the given radix, least significant
+    // first. The magnitude is split in a scratch copy.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::ScratchVector
+    BasicBigInt<Limb, Allocator>::toRadix(Group radix) const {
+        auto n = data.size();
+        auto powers = Scratch::radixPowers(radix, n, SHARED_POWERS);
+        auto level = powers.size() - 1;
+        auto digits = ScratchVector(size_t(2) << level, 0);
+        Scratch::toRadix(fromGroups(data.data(), n, 0, n), powers, level,
+                         digits.data(), radix);
+        while (digits.size() > 1 && digits.back() == 0) {
+            digits.pop_back();
+        }
+        return digits;
+    }
+
+    // radix^(2^k) for k = 0, 1, ..., until the square of the last one
+    // is larger than any number of the given size in groups. Shared
+    // powers live in a process-wide cache that only ever grows, so the
+    // pointers stay valid while other threads extend it; it is built on
+    // the heap, as it outlives the operation. Otherwise the powers are
+    // owned by the table.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::PowerTable
+    BasicBigInt<Limb, Allocator>::radixPowers(Group radix, size_t groups,
+                                              bool shared) {
+        using Powers = decltype(PowerTable::owned);
+        PowerTable table;
+        // Room for every level, so that the table never grows on the heap
+        table.reserve(std::numeric_limits<size_t>::digits);
+        auto powers = &table.owned;
+        std::unique_lock<std::mutex> lock;
+        detail::ScratchBypass bypass(shared);
+        if (shared) {
+            static std::mutex mutex;
+            static std::map<Group, Powers> cache;
+            lock = std::unique_lock<std::mutex>(mutex);
+            powers = &cache[radix];
+        }
+        if (powers->empty()) {
+            powers->emplace_back(radix);
+        }
+        table.push_back(&powers->front());
+        while (2 * table.back()->data.size() - 1 <= groups) {
+            if (table.size() == powers->size()) {
+                auto power = powers->back();
+                powers->push_back(std::move(power.square()));
+            }
+            table.push_back(&(*powers)[table.size()]);
+        }
+        return table;
+    }
+
+    // Builds the cached powers needed to convert numbers of up to the
+    // given number of digits in the base, so that later conversions
+    // don't pay for them. Does nothing useful for stateful allocators.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::prewarmPowers(size_t digits, int base) {
+        if (base < 2 || base > 36 || powerOfTwo(base)) {
+            return;
+        }
+        auto bits = digits * std::log2(base);
+        Scratch::radixPowers(groupRadix(base), bits / GROUP_BIT_SIZE + 1,
+                             SHARED_POWERS);
+    }
+
+    // Writes exactly 2^(level + 1) digits of value < radix^(2^(level + 1))
+    // to out, splitting by powers[level] until the pieces are small enough
+    // for repeated single-group division.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::toRadix(Scratch value,
+                                               const PowerTable& powers,
+                                               size_t level, Group* out,
+                                               Group radix) {
+        auto count = size_t(2) << level;
+        if (count <= std::max(thresholds().radixConversion, size_t(2))) {
+            auto n = value.data.size();
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = divGroups1(value.data.data(), value.data.data(), n,
+                                    radix);
+                while (n > 1 && value.data[n - 1] == 0) {
+                    --n;
+                }
+            }
+            return;
+        }
+        Scratch low;
+        value.divide(*powers[level], &low);
+        toRadix(std::move(low), powers, level - 1, out, radix);
+        toRadix(std::move(value), powers, level - 1, out + count / 2, radix);
+    }
+
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::shrink() {
+        while (data.back() == 0 && data.size() > 1) {
+            data.pop_back();
+        }
+    }
+
+    template<typename Limb, typename Allocator>
+    bool BasicBigInt<Limb, Allocator>::isZero() const {
+        return data.size() == 1 && data[0] == 0;
+    }
+
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::add(const BasicBigInt& rhs) {
+        if (data.size() < rhs.data.size()) {
+            data.resize(rhs.data.size(), 0);
+        }
+        auto carry = addGroups(data.data(), data.data(), data.size(),
+                               rhs.data.data(), rhs.data.size());
+        if (carry > 0) {
+            data.push_back(carry);
+        }
+    }
+
+    // Subtracts the magnitude of rhs, flipping the sign if it is the larger
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::sub(const BasicBigInt& rhs) {
+        auto size = data.size();
+        if (compareGroups(data.data(), size,
+                          rhs.data.data(), rhs.data.size()) >= 0) {
+            subGroups(data.data(), data.data(), size,
+                      rhs.data.data(), rhs.data.size());
+        } else {
+            data.resize(rhs.data.size(), 0);
+            subGroups(data.data(), rhs.data.data(), rhs.data.size(),
+                      data.data(), size);
+            signal = !signal;
+        }
+    }
+
+    // Adds a native integer given as sign and magnitude
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::addSmall(bool negative,
+                                                uintmax_t value) {
+        if (value > GROUP_MAX) {
+            BasicBigInt other(value, get_allocator());
+            other.signal = negative;
+            *this += other;
+            return;
+        }
+        Group group = value;
+        if (signal == negative) {
+            auto carry = addGroups(data.data(), data.data(), data.size(),
+                                   &group, 1);
+            if (carry > 0) {
+                data.push_back(carry);
+            }
+        } else if (data.size() > 1 || data[0] >= group) {
+            subGroups(data.data(), data.data(), data.size(), &group, 1);
+        } else {
+            data[0] = group - data[0];
+            signal = !signal;
+        }
+        shrink();
+        if (isZero()) {
+            signal = POSITIVE;
+        }
+    }
+
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::mulSmall(bool negative,
+                                                uintmax_t value) {
+        if (value > GROUP_MAX) {
+            BasicBigInt other(value, get_allocator());
+            other.signal = negative;
+            mult(*this, other);
+        } else {
+            auto carry = mulGroups1(data.data(), data.data(), data.size(),
+                                    value);
+            if (carry > 0) {
+                data.push_back(carry);
+            }
+            signal = signal != negative;
+        }
+        shrink();
+        if (isZero()) {
+            signal = POSITIVE;
+        }
+    }
+
+    // Truncating division by a native integer, returning the magnitude of
+    // the remainder (whose sign is the one of the dividend).
+    template<typename Limb, typename Allocator>
+    uintmax_t BasicBigInt<Limb, Allocator>::divSmall(bool negative,
+                                                     uintmax_t value) {
+        if (value == 0) {
+            throw std::runtime_error("BigInt division by zero");
+        }
+        uintmax_t remainder;
+        if (value > GROUP_MAX) {
+            remainder = divGroupsWide(data.data(), data.data(), data.size(),
+                                      value);
+        } else {
+            remainder = divGroups1(data.data(), data.data(), data.size(),
+                                   value);
+        }
+        signal = signal != negative;
+        shrink();
+        if (isZero()) {
+            signal = POSITIVE;
+        }
+        return remainder;
+    }
+
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Thresholds&
+    BasicBigInt<Limb, Allocator>::thresholds() {
+        if constexpr (std::is_same<BasicBigInt, Scratch>::value) {
+            static Thresholds values;
+            return values;
+        } else {
+            return Scratch::thresholds();
+        }
+    }
+
+    // r[0..an) = a[0..an) + b[0..bn), with an >= bn. Returns the carry.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Group
+    BasicBigInt<Limb, Allocator>::addGroups(Group* r, const Group* a, size_t an,
+                                            const Group* b, size_t bn) {
+        auto add = bn < detail::KERNEL_BLOCK ? &detail::addGroupsScalar<Group>
+                                             : detail::groupKernels<Group>().add;
+        DoubleGroup carry = add(r, a, b, bn, 0);
+        for (size_t i = bn; i < an; ++i) {
+            DoubleGroup result = carry + a[i];
+            r[i] = result;
+            carry = result >> GROUP_BIT_SIZE;
+        }
+        return carry;
+    }
+
+    // r[0..an) = a[0..an) - b[0..bn), with an >= bn. Returns the borrow.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Group
+    BasicBigInt<Limb, Allocator>::subGroups(Group* r, const Group* a, size_t an,
+                                            const Group* b, size_t bn) {
+        auto sub = bn < detail::KERNEL_BLOCK ? &detail::subGroupsScalar<Group>
+                                             : detail::groupKernels<Group>().sub;
+        DoubleGroup borrow = sub(r, a, b, bn, 0);
+        for (size_t i = bn; i < an; ++i) {
+            DoubleGroup result = DoubleGroup(a[i]) - borrow;
+            r[i] = result;
+            borrow = (result >> GROUP_BIT_SIZE) & 1;
+        }
+        return borrow;
+    }
+
+    template<typename Limb, typename Allocator>
+    int BasicBigInt<Limb, Allocator>::compareGroups(const Group* a, size_t an,
+                                                    const Group* b, size_t bn) {
+        for (; an > bn; --an) {
+            if (a[an - 1] != 0) return 1;
+        }
+        for (; bn > an; --bn) {
+            if (b[bn - 1] != 0) return -1;
+        }
+        for (size_t i = an; i > 0; --i) {
+            if (a[i - 1] != b[i - 1]) {
+                return a[i - 1] < b[i - 1] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    // r[0..n) = a[0..n) * b, returning the carry. r may alias a.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Group
+    BasicBigInt<Limb, Allocator>::mulGroups1(Group* r, const Group* a,
+                                             size_t n, Group b) {
+        if (n < detail::KERNEL_BLOCK) {
+            return detail::mulGroups1Scalar<Group>(r, a, n, b, 0);
+        }
+        return detail::groupKernels<Group>().mul1(r, a, n, b, 0);
+    }
+
+    // r[0..n) += a[0..n) * b, returning the carry.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Group
+    BasicBigInt<Limb, Allocator>::addMulGroups1(Group* r, const Group* a,
+                                                size_t n, Group b) {
+        if (n < detail::KERNEL_BLOCK) {
+            return detail::addMulGroups1Scalar<Group>(r, a, n, b, 0);
+        }
+        return detail::groupKernels<Group>().addMul1(r, a, n, b, 0);
+    }
+
+    // q[0..n) = a[0..n) / d, returning the remainder. q may alias a.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Group
+    BasicBigInt<Limb, Allocator>::divGroups1(Group* q, const Group* a,
+                                             size_t n, Group d) {
+        DoubleGroup remainder = 0;
+        for (size_t i = n; i > 0; --i) {
+            remainder = (remainder << GROUP_BIT_SIZE) | a[i - 1];
+            q[i - 1] = remainder / d;
+            remainder %= d;
+        }
+        return remainder;
+    }
+
+    // r[0..n) -= a[0..n) * b, returning the borrow.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Group
+    BasicBigInt<Limb, Allocator>::subMulGroups1(Group* r, const Group* a,
+                                                size_t n, Group b) {
+        DoubleGroup borrow = 0;
+        for (size_t i = 0; i < n; ++i) {
+            DoubleGroup product = b;
+            product = product * a[i] + borrow;
+            Group low = product;
+            borrow = (product >> GROUP_BIT_SIZE) + (r[i] < low);
+            r[i] -= low;
+        }
+        return borrow;
+    }
+
+    // q[0..an-bn] = a[0..an) / b[0..bn) and r[0..bn) = a[0..an) % b[0..bn).
+    // Requires an >= bn and a nonzero top group in b.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::divGroups(Group* q, Group* r,
+                                                 const Group* a, size_t an,
+                                                 const Group* b, size_t bn) {
+        if (bn == 1) {
+            r[0] = divGroups1(q, a, an, b[0]);
+            return;
+        }
+        // Normalizes so that the top bit of the divisor is set
+        auto shift = leadingZeros(b[bn - 1]);
+        auto u = ScratchVector(an + 1, 0);
+        auto v = ScratchVector(bn, 0);
+        if (shift > 0) {
+            for (size_t i = bn - 1; i > 0; --i) {
+                v[i] = (b[i] << shift) | (b[i - 1] >> (GROUP_BIT_SIZE - shift));
+            }
+            v[0] = b[0] << shift;
+            u[an] = a[an - 1] >> (GROUP_BIT_SIZE - shift);
+            for (size_t i = an - 1; i > 0; --i) {
+                u[i] = (a[i] << shift) | (a[i - 1] >> (GROUP_BIT_SIZE - shift));
+            }
+            u[0] = a[0] << shift;
+        } else {
+            std::copy(b, b + bn, v.begin());
+            std::copy(a, a + an, u.begin());
+        }
+        knuthDiv(q, u.data(), an, v.data(), bn);
+        if (shift > 0) {
+            for (size_t i = 0; i < bn - 1; ++i) {
+                r[i] = (u[i] >> shift) | (u[i + 1] << (GROUP_BIT_SIZE - shift));
+            }
+            r[bn - 1] = u[bn - 1] >> shift;
+        } else {
+            std::copy(u.begin(), u.begin() + bn, r);
+        }
+    }
+
+    // Knuth's algorithm D. Divides u[0..un] by the normalized v[0..vn),
+    // vn >= 2, leaving the quotient in q[0..un-vn] and the remainder
+    // in u[0..vn).
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::knuthDiv(Group* q, Group* u, size_t un,
+                                                const Group* v, size_t vn) {
+        auto top = v[vn - 1];
+        auto next = v[vn - 2];
+        for (size_t j = un - vn + 1; j > 0; --j) {
+            auto window = u + j - 1;
+            DoubleGroup numerator = window[vn];
+            numerator = (numerator << GROUP_BIT_SIZE) | window[vn - 1];
+            DoubleGroup estimate = numerator / top;
+            DoubleGroup rest = numerator % top;
+            // At most two corrections bring the estimate within one
+            while (estimate > GROUP_MAX ||
+                   estimate * next > ((rest << GROUP_BIT_SIZE) | window[vn - 2])) {
+                --estimate;
+                rest += top;
+                if (rest > GROUP_MAX) {
+                    break;
+                }
+            }
+            auto borrow = subMulGroups1(window, v, vn, estimate);
+            if (window[vn] < borrow) {
+                window[vn] -= borrow;
+                --estimate;
+                window[vn] += addGroups(window, window, vn, v, vn);
+            } else {
+                window[vn] -= borrow;
+            }
+            q[j - 1] = estimate;
+        }
+    }
+
+    // Bit-by-bit long division, for divisors that do not fit in a group.
+    template<typename Limb, typename Allocator>
+    uintmax_t BasicBigInt<Limb, Allocator>::divGroupsWide(Group* q,
+                                                          const Group* a,
+                                                          size_t n,
+                                                          uintmax_t d) {
+        constexpr auto WIDE_BIT_SIZE = std::numeric_limits<uintmax_t>::digits;
+        uintmax_t remainder = 0;
+        for (size_t i = n; i > 0; --i) {
+            Group quotient = 0;
+            for (auto bit = GROUP_BIT_SIZE; bit > 0; --bit) {
+                bool overflow = remainder >> (WIDE_BIT_SIZE - 1);
+                remainder = (remainder << 1) | ((a[i - 1] >> (bit - 1)) & 1);
+                quotient <<= 1;
+                if (overflow || remainder >= d) {
+                    remainder -= d;
+                    quotient |= 1;
+                }
+            }
+            q[i - 1] = quotient;
+        }
+        return remainder;
+    }
+
+    // The value of groups[offset..offset+length), clamped to n groups.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Scratch
+    BasicBigInt<Limb, Allocator>::fromGroups(const Group* groups, size_t n,
+                                             size_t offset, size_t length) {
+        Scratch value;
+        if (offset < n) {
+            length = std::min(length, n - offset);
+            value.data.resize(length);
+            std::copy(groups + offset, groups + offset + length,
+                      value.data.begin());
+            value.shrink();
+        }
+        return value;
+    }
+
+    // r[offset..n) += value, for a non-negative value that fits.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::addInto(Group* r, size_t n,
+                                               size_t offset,
+                                               const Scratch& value) {
+        if (offset >= n) {
+            return;
+        }
+        auto length = std::min(value.data.size(), n - offset);
+        addGroups(r + offset, r + offset, n - offset,
+                  value.data.data(), length);
+    }
+
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::divExact(Group divisor) {
+        divGroups1(data.data(), data.data(), data.size(), divisor);
+        shrink();
+    }
+
+    // r[0..an+bn) = a[0..an) * b[0..bn), with an >= bn. r must not overlap
+    // the operands.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::multGroups(Group* r, const Group* a,
+                                                  size_t an, const Group* b,
+                                                  size_t bn) {
+        auto& limits = thresholds();
+        // Below these sizes the splits would not shrink the operands
+        auto karatsuba = std::max<size_t>(limits.karatsuba, 2);
+        auto toom3 = std::max<size_t>(limits.toom3, 3);
+        auto toom4 = std::max<size_t>(limits.toom4, 3);
+        auto pieces = (an + bn) * (sizeof(Group) / sizeof(uint32_t));
+        if (a == b && an == bn) {
+            squareGroups(r, a, an);
+        } else if (bn < karatsuba) {
+            longMult(r, a, an, b, bn);
+        } else if (bn >= limits.ntt && pieces <= NTT_MAX_LENGTH) {
+            nttMult(r, a, an, b, bn);
+        } else if (2 * an >= 5 * bn || (an != bn && bn < toom3)) {
+            // Unbalanced: multiply b by bn-sized slices of a
+            std::fill(r, r + an + bn, 0);
+            ScratchVector slice_product(2 * bn, 0);
+            for (size_t offset = 0; offset < an; offset += bn) {
+                auto length = std::min(bn, an - offset);
+                if (length == bn) {
+                    multGroups(slice_product.data(), a + offset, bn, b, bn);
+                } else {
+                    multGroups(slice_product.data(), b, bn, a + offset, length);
+                }
+                auto remaining = an + bn - offset;
+                addGroups(r + offset, r + offset, remaining,
+                          slice_product.data(), length + bn);
+            }
+        } else if (bn < toom3) {
+            karatsubaMult(r, a, b, an);
+        } else if (2 * an >= 3 * bn) {
+            toom32Mult(r, a, an, b, bn);
+        } else if (bn < toom4) {
+            toom3Mult(r, a, an, b, bn);
+        } else {
+            toom4Mult(r, a, an, b, bn);
+        }
+    }
+
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::longMult(Group* r, const Group* a,
+                                                size_t an, const Group* b,
+                                                size_t bn) {
+        auto vectorized = detail::groupKernels<Group>().mult;
+        if (vectorized && vectorized(r, a, an, b, bn)) {
+            return;
+        }
+        r[an] = mulGroups1(r, a, an, b[0]);
+        for (size_t i = 1; i < bn; ++i) {
+            r[an + i] = addMulGroups1(r + i, a, an, b[i]);
+        }
+    }
+
+    // r[0..2n) = a[0..n)^2. r must not overlap a.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::squareGroups(Group* r, const Group* a,
+                                                    size_t n) {
+        auto& limits = thresholds();
+        auto karatsuba = std::max<size_t>(limits.karatsuba, 2);
+        auto toom3 = std::max<size_t>(limits.toom3, 3);
+        auto toom4 = std::max<size_t>(limits.toom4, 3);
+        auto pieces = 2 * n * (sizeof(Group) / sizeof(uint32_t));
+        if (n < karatsuba) {
+            longSquare(r, a, n);
+        } else if (n >= limits.ntt && pieces <= NTT_MAX_LENGTH) {
+            nttMult(r, a, n, a, n);
+        } else if (n < toom3) {
+            karatsubaSquare(r, a, n);
+        } else if (n < toom4) {
+            toom3Mult(r, a, n, a, n);
+        } else {
+            toom4Mult(r, a, n, a, n);
+        }
+    }
+
+    // Schoolbook squaring: each cross product a[i] a[j], i < j, is computed
+    // once and doubled, then the squares a[i]^2 are added on the diagonal.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::longSquare(Group* r, const Group* a,
+                                                  size_t n) {
+        auto vectorized = detail::groupKernels<Group>().mult;
+        if (vectorized && vectorized(r, a, n, a, n)) {
+            return;
+        }
+        std::fill(r, r + 2 * n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            DoubleGroup carry = 0;
+            for (size_t j = i + 1; j < n; ++j) {
+                DoubleGroup result = a[i];
+                result = r[i + j] + result * a[j] + carry;
+                r[i + j] = result;
+                carry = result >> GROUP_BIT_SIZE;
+            }
+            r[i + n] = carry;
+        }
+        detail::groupKernels<Group>().shiftLeft(r, r, 2 * n, 1);
+        DoubleGroup carry = 0;
+        for (size_t i = 0; i < n; ++i) {
+            DoubleGroup square = a[i];
+            square *= a[i];
+            DoubleGroup result = carry + r[2 * i] + Group(square);
+            r[2 * i] = result;
+            carry = result >> GROUP_BIT_SIZE;
+            result = carry + r[2 * i + 1] + (square >> GROUP_BIT_SIZE);
+            r[2 * i + 1] = result;
+            carry = result >> GROUP_BIT_SIZE;
+        }
+    }
+
+    // Karatsuba squaring: z1 = z0 + z2 - (x0 - x1)^2, which is never
+    // negative, so no sign needs tracking.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::karatsubaSquare(Group* r, const Group* a,
+                                                       size_t n) {
+        auto low = (n + 1) / 2;
+        auto high = n - low;
+        ScratchVector scratch(5 * low + 1, 0);
+        auto diff = scratch.data();
+        auto middle = diff + low;
+        auto sum = middle + 2 * low;
+
+        if (compareGroups(a, low, a + low, high) >= 0) {
+            subGroups(diff, a, low, a + low, high);
+        } else {
+            subGroups(diff, a + low, high, a, high);
+            std::fill(diff + high, diff + low, 0);
+        }
+
+        squareGroups(r, a, low);
+        squareGroups(r + 2 * low, a + low, high);
+        squareGroups(middle, diff, low);
+
+        sum[2 * low] = addGroups(sum, r, 2 * low, r + 2 * low, 2 * high);
+        subGroups(sum, sum, 2 * low + 1, middle, 2 * low);
+        auto sum_size = std::min(2 * low + 1, n + high);
+        addGroups(r + low, r + low, n + high, sum, sum_size);
+    }
+
+    // Karatsuba over two n-group operands split as x = x1 * R^low + x0:
+    // x * y = z2 * R^(2 low) + z1 * R^low + z0, with
+    // z1 = z0 + z2 - (x0 - x1) * (y0 - y1).
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::karatsubaMult(Group* r, const Group* a,
+                                                     const Group* b, size_t n) {
+        auto low = (n + 1) / 2;
+        auto high = n - low;
+        ScratchVector scratch(6 * low + 1, 0);
+        auto a_diff = scratch.data();
+        auto b_diff = a_diff + low;
+        auto middle = b_diff + low;
+        auto sum = middle + 2 * low;
+
+        auto absDiff = [low, high](Group* d, const Group* x) {
+            if (compareGroups(x, low, x + low, high) >= 0) {
+                subGroups(d, x, low, x + low, high);
+                return false;
+            }
+            subGroups(d, x + low, high, x, high);
+            std::fill(d + high, d + low, 0);
+            return true;
+        };
+        auto a_negative = absDiff(a_diff, a);
+        auto b_negative = absDiff(b_diff, b);
+
+        multGroups(r, a, low, b, low);
+        multGroups(r + 2 * low, a + low, high, b + low, high);
+        multGroups(middle, a_diff, low, b_diff, low);
+
+        sum[2 * low] = addGroups(sum, r, 2 * low, r + 2 * low, 2 * high);
+        if (a_negative == b_negative) {
+            subGroups(sum, sum, 2 * low + 1, middle, 2 * low);
+        } else {
+            addGroups(sum, sum, 2 * low + 1, middle, 2 * low);
+        }
+        // z1 < 2 R^n, so whatever of sum goes past the product is zero
+        auto sum_size = std::min(2 * low + 1, n + high);
+        addGroups(r + low, r + low, n + high, sum, sum_size);
+    }
 
-        GroupVector toDecimal() const;
+    // Toom-3.2, for 1.5 bn <= an < 2.5 bn: a is split in three parts and
+    // b in two, evaluated at 0, 1, -1 and infinity. Written in terms of
+    // the compound operators, as the free ones are not declared yet.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::toom32Mult(Group* r, const Group* a,
+                                                  size_t an, const Group* b,
+                                                  size_t bn) {
+        auto k = (an + 2) / 3;
+        auto a0 = fromGroups(a, an, 0, k);
+        auto a1 = fromGroups(a, an, k, k);
+        auto a2 = fromGroups(a, an, 2 * k, k);
+        auto b0 = fromGroups(b, bn, 0, k);
+        auto b1 = fromGroups(b, bn, k, k);
 
-        static GroupVector convertBase(uintmax_t);
-        static GroupVector convertBase(const std::string&);
-        static void twoComplement(GroupVector&, Group);
-    };
+        auto a_pos = a0;
+        a_pos += a2;
+        auto a_neg = a_pos;
+        a_pos += a1;
+        a_neg -= a1;
+        auto b_pos = b0;
+        b_pos += b1;
+        auto b_neg = std::move(b0);
+        b_neg -= b1;
 
-    template<typename T, std::enable_if_t<std::is_unsigned<T>::value, int>>
-    BigInt::BigInt(T value): data{convertBase(value)} { }
+        auto w0 = std::move(a0);
+        w0 *= fromGroups(b, bn, 0, k);
+        auto w1 = std::move(a_pos);
+        w1 *= b_pos;
+        auto wm1 = std::move(a_neg);
+        wm1 *= b_neg;
+        auto winf = std::move(a2);
+        winf *= b1;
 
-    template<typename T, std::enable_if_t<std::is_signed<T>::value, int>>
-    BigInt::BigInt(T value):
-     signal{value < 0}, data{convertBase(std::abs(value))} { }
+        // c2 = (w1 + wm1) / 2 - c0, c1 = (w1 - wm1) / 2 - c3
+        auto c2 = w1;
+        c2 += wm1;
+        c2.divExact(2);
+        c2 -= w0;
+        auto c1 = std::move(w1);
+        c1 -= wm1;
+        c1.divExact(2);
+        c1 -= winf;
 
-    inline BigInt BigInt::fromString(const std::string& str_value) {
-        std::regex number_regex("\\s*(\\+|-)?\\s*([0-9]+)\\s*");
-        std::smatch number_match;
-        if (!std::regex_match(str_value, number_match, number_regex)) {
-            throw std::runtime_error(
-                "Could not create BigInt from string: non-integer value"
-            );
-        }
-        BigInt integer;
-        integer.data = convertBase(number_match[2]);
-        integer.signal = number_match[1] == "-";
-        integer.shrink();
-        return integer;
+        std::fill(r, r + an + bn, 0);
+        addInto(r, an + bn, 0, w0);
+        addInto(r, an + bn, k, c1);
+        addInto(r, an + bn, 2 * k, c2);
+        addInto(r, an + bn, 3 * k, winf);
     }
 
-    inline BigInt::GroupVector BigInt::convertBase(uintmax_t value) {
-        GroupVector data;
-        if (value != 0) {
-            while (value > 0) {
-                data.emplace_back(value & GROUP_MAX);
-                value >>= GROUP_BIT_SIZE;
+    // Toom-3, evaluated at 0, 1, -1, 2 and infinity.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::toom3Mult(Group* r, const Group* a,
+                                                 size_t an, const Group* b,
+                                                 size_t bn) {
+        auto k = (an + 2) / 3;
+        auto squaring = a == b && an == bn;
+        Scratch w[5];
+        Scratch values[5];
+        for (auto i = 0; i < (squaring ? 1 : 2); ++i) {
+            auto groups = i == 0 ? a : b;
+            auto n = i == 0 ? an : bn;
+            auto x0 = fromGroups(groups, n, 0, k);
+            auto x1 = fromGroups(groups, n, k, k);
+            auto x2 = fromGroups(groups, n, 2 * k, k);
+            values[1] = x0;
+            values[1] += x2;
+            values[2] = values[1];
+            values[1] += x1;
+            values[2] -= x1;
+            values[3] = std::move(x2);
+            values[3] <<= 1;
+            values[3] += x1;
+            values[3] <<= 1;
+            values[3] += x0;
+            values[0] = std::move(x0);
+            values[4] = fromGroups(groups, n, 2 * k, k);
+            for (auto j = 0; j < 5; ++j) {
+                if (i == 0) {
+                    w[j] = std::move(values[j]);
+                } else {
+                    w[j] *= values[j];
+                }
             }
-        } else {
-            data.emplace_back(0);
         }
-        return data;
+        if (squaring) {
+            for (auto& value : w) {
+                value.square();
+            }
+        }
+        auto& c0 = w[0];
+        auto& c4 = w[4];
+
+        // c2 = (w1 + wm1) / 2 - c0 - c4
+        auto c2 = w[1];
+        c2 += w[2];
+        c2.divExact(2);
+        c2 -= c0;
+        c2 -= c4;
+        // c1 + c3 = (w1 - wm1) / 2
+        auto odd = std::move(w[1]);
+        odd -= w[2];
+        odd.divExact(2);
+        // c1 + 4 c3 = (w2 - c0 - 4 c2 - 16 c4) / 2
+        auto c3 = std::move(w[3]);
+        c3 -= c0;
+        auto scaled = c4;
+        scaled <<= 2;
+        scaled += c2;
+        scaled <<= 2;
+        c3 -= scaled;
+        c3.divExact(2);
+        c3 -= odd;
+        c3.divExact(3);
+        auto c1 = std::move(odd);
+        c1 -= c3;
+
+        std::fill(r, r + an + bn, 0);
+        addInto(r, an + bn, 0, c0);
+        addInto(r, an + bn, k, c1);
+        addInto(r, an + bn, 2 * k, c2);
+        addInto(r, an + bn, 3 * k, c3);
+        addInto(r, an + bn, 4 * k, c4);
     }
 
-    inline BigInt::GroupVector BigInt::convertBase(const std::string& str_value) {
-        GroupVector data;
-        auto i = str_value.size();
-        while (i > 0) {
-            if (i > 8) {
-                i = i - 9;
-                data.emplace_back(std::stoull(str_value.substr(i, 9)));
-            } else {
-                data.emplace_back(std::stoull(str_value.substr(0, i)));
-                i = 0;
+    // Toom-4, evaluated at 0, 1, -1, 2, -2, 1/2 and infinity.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::toom4Mult(Group* r, const Group* a,
+                                                 size_t an, const Group* b,
+                                                 size_t bn) {
+        auto k = (an + 3) / 4;
+        auto squaring = a == b && an == bn;
+        Scratch w[7];
+        Scratch values[7];
+        for (auto i = 0; i < (squaring ? 1 : 2); ++i) {
+            auto groups = i == 0 ? a : b;
+            auto n = i == 0 ? an : bn;
+            Scratch x[4];
+            for (auto j = 0; j < 4; ++j) {
+                x[j] = fromGroups(groups, n, j * k, k);
+            }
+            // x(1) and x(-1)
+            auto even = x[0];
+            even += x[2];
+            auto odd = x[1];
+            odd += x[3];
+            values[1] = even;
+            values[1] += odd;
+            values[2] = std::move(even);
+            values[2] -= odd;
+            // x(2) and x(-2)
+            even = x[2];
+            even <<= 2;
+            even += x[0];
+            odd = x[3];
+            odd <<= 2;
+            odd += x[1];
+            odd <<= 1;
+            values[3] = even;
+            values[3] += odd;
+            values[4] = std::move(even);
+            values[4] -= odd;
+            // 8 x(1/2)
+            values[5] = x[0];
+            values[5] <<= 1;
+            values[5] += x[1];
+            values[5] <<= 1;
+            values[5] += x[2];
+            values[5] <<= 1;
+            values[5] += x[3];
+            values[0] = std::move(x[0]);
+            values[6] = std::move(x[3]);
+            for (auto j = 0; j < 7; ++j) {
+                if (i == 0) {
+                    w[j] = std::move(values[j]);
+                } else {
+                    w[j] *= values[j];
+                }
             }
         }
-        size_t k = 0;
-        while (k < data.size()) {
-            for (size_t i = data.size() - 1; i > k; --i) {
-                DoubleGroup true_value = data[i] * 1000000000ull + data[i - 1];
-                data[i - 1] = true_value;
-                data[i] = true_value >> GROUP_BIT_SIZE;
+        if (squaring) {
+            for (auto& value : w) {
+                value.square();
             }
-            while (data.back() == 0 && data.size() > 1) data.pop_back();
-            k++;
         }
-        return data;
+        auto& c0 = w[0];
+        auto& c6 = w[6];
+
+        // Even coefficients, from c2 + c4 and c2 + 4 c4
+        auto even1 = w[1];
+        even1 += w[2];
+        even1.divExact(2);
+        even1 -= c0;
+        even1 -= c6;
+        auto even2 = w[3];
+        even2 += w[4];
+        even2.divExact(2);
+        even2 -= c0;
+        auto scaled = c6;
+        scaled <<= 6;
+        even2 -= scaled;
+        even2.divExact(4);
+        auto c4 = std::move(even2);
+        c4 -= even1;
+        c4.divExact(3);
+        auto c2 = std::move(even1);
+        c2 -= c4;
+
+        // Odd coefficients, from c1 + c3 + c5, c1 + 4 c3 + 16 c5 and
+        // 16 c1 + 4 c3 + c5
+        auto odd1 = std::move(w[1]);
+        odd1 -= w[2];
+        odd1.divExact(2);
+        auto odd2 = std::move(w[3]);
+        odd2 -= w[4];
+        odd2.divExact(4);
+        auto half = std::move(w[5]);
+        scaled = c0;
+        scaled <<= 2;
+        scaled += c2;
+        scaled <<= 2;
+        scaled += c4;
+        scaled <<= 2;
+        half -= scaled;
+        half -= c6;
+        half.divExact(2);
+        // c3 + 5 c5
+        auto t = std::move(odd2);
+        t -= odd1;
+        t.divExact(3);
+        // 4 c3 + 5 c5
+        auto u = odd1;
+        u <<= 4;
+        u -= half;
+        u.divExact(3);
+        auto c3 = std::move(u);
+        c3 -= t;
+        c3.divExact(3);
+        auto c5 = std::move(t);
+        c5 -= c3;
+        c5.divExact(5);
+        auto c1 = std::move(odd1);
+        c1 -= c3;
+        c1 -= c5;
+
+        std::fill(r, r + an + bn, 0);
+        addInto(r, an + bn, 0, c0);
+        addInto(r, an + bn, k, c1);
+        addInto(r, an + bn, 2 * k, c2);
+        addInto(r, an + bn, 3 * k, c3);
+        addInto(r, an + bn, 4 * k, c4);
+        addInto(r, an + bn, 5 * k, c5);
+        addInto(r, an + bn, 6 * k, c6);
     }
 
-    inline BigInt::GroupVector BigInt::toDecimal() const {
-        auto dec_data = data;
-        size_t k = 0;
-        while (k < dec_data.size()) {
-            for (size_t i = dec_data.size() - 1; i > k; --i) {
-                DoubleGroup true_value = dec_data[i] * GROUP_RADIX;
-                true_value += dec_data[i - 1];
-                dec_data[i - 1] = true_value % 1000000000ull;
-                DoubleGroup q = true_value / 1000000000ull;
-                if (q > GROUP_RADIX) {
-                    if (i < dec_data.size() - 1) {
-                        DoubleGroup value = (q / GROUP_RADIX);
-                        dec_data[i + 1] += value;
-                    } else {
-                        dec_data.emplace_back(q / GROUP_RADIX);
-                    }
-                    q = q % GROUP_RADIX;
-                }
-                dec_data[i] = q;
+    template<typename Limb, typename Allocator>
+    uint32_t BasicBigInt<Limb, Allocator>::powMod(uint64_t base,
+                                                  uint64_t exponent,
+                                                  uint32_t modulus) {
+        uint64_t result = 1;
+        base %= modulus;
+        while (exponent > 0) {
+            if (exponent & 1) {
+                result = result * base % modulus;
             }
-            k++;
-        }
-
-        if (dec_data.back() > 1000000000ull) {
-            auto q = dec_data.back() / 1000000000ull;
-            dec_data.back() = dec_data.back() % 1000000000ull;
-            dec_data.push_back(q);
+            base = base * base % modulus;
+            exponent >>= 1;
         }
-
-        return dec_data;
+        return result;
     }
 
-    void BigInt::twoComplement(GroupVector& data, Group signal) {
-        DoubleGroup carry = 1;
-        for (auto& segment : data) {
-            DoubleGroup complement = carry + ~segment;
-            segment = complement;
-            carry = complement >> GROUP_BIT_SIZE;
+    // In-place iterative number-theoretic transform over Z/Modulus, whose
+    // multiplicative group is generated by Root.
+    template<typename Limb, typename Allocator>
+    template<uint32_t Modulus, uint32_t Root>
+    void BasicBigInt<Limb, Allocator>::ntt(NttVector& values, bool inverse) {
+        auto n = values.size();
+        for (size_t i = 1, j = 0; i < n; ++i) {
+            auto bit = n >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j) {
+                std::swap(values[i], values[j]);
+            }
         }
-        if ((~signal + carry) == 1) {
-            data.emplace_back(signal);
+        NttVector roots(std::max<size_t>(n / 2, 1));
+        for (size_t length = 2; length <= n; length <<= 1) {
+            uint64_t step = powMod(Root, (Modulus - 1) / length, Modulus);
+            if (inverse) {
+                step = powMod(step, Modulus - 2, Modulus);
+            }
+            auto half = length / 2;
+            roots[0] = 1;
+            for (size_t i = 1; i < half; ++i) {
+                roots[i] = roots[i - 1] * step % Modulus;
+            }
+            for (size_t i = 0; i < n; i += length) {
+                auto low = values.data() + i;
+                auto high = low + half;
+                for (size_t j = 0; j < half; ++j) {
+                    uint32_t u = low[j];
+                    uint32_t v = uint64_t(high[j]) * roots[j] % Modulus;
+                    low[j] = u + v >= Modulus ? u + v - Modulus : u + v;
+                    high[j] = u >= v ? u - v : u + Modulus - v;
+                }
+            }
+        }
+        if (inverse) {
+            uint64_t scale = powMod(n, Modulus - 2, Modulus);
+            for (auto& value : values) {
+                value = value * scale % Modulus;
+            }
         }
     }
 
-    inline void BigInt::shrink() {
-        while (data.back() == 0 && data.size() > 1) {
-            data.pop_back();
+    // Cyclic convolution of a and b modulo Modulus, left in a. A null b
+    // convolves a with itself, saving one transform.
+    template<typename Limb, typename Allocator>
+    template<uint32_t Modulus, uint32_t Root>
+    void BasicBigInt<Limb, Allocator>::nttConvolution(NttVector& a,
+                                                      const NttVector* b) {
+        for (auto& value : a) {
+            value %= Modulus;
+        }
+        ntt<Modulus, Root>(a, false);
+        if (b != nullptr) {
+            auto transformed = *b;
+            for (auto& value : transformed) {
+                value %= Modulus;
+            }
+            ntt<Modulus, Root>(transformed, false);
+            for (size_t i = 0; i < a.size(); ++i) {
+                a[i] = uint64_t(a[i]) * transformed[i] % Modulus;
+            }
+        } else {
+            for (auto& value : a) {
+                value = uint64_t(value) * value % Modulus;
+            }
         }
+        ntt<Modulus, Root>(a, true);
     }
 
-    template<typename Operation>
-    BigInt::DoubleGroup BigInt::carryOn(const BigInt& rhs,
-                                        DoubleGroup carry,
-                                        const Operation& op) {
-        if (data.size() < rhs.data.size()) {
-            data.insert(data.end(), rhs.data.size() - data.size(), 0);
+    // Multiplication through convolutions modulo three NTT primes, with
+    // the operands cut in 32-bit pieces. Each coefficient of the product
+    // is below 2^88 and is rebuilt from its residues with Garner's CRT.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::nttMult(Group* r, const Group* a,
+                                               size_t an, const Group* b,
+                                               size_t bn) {
+        constexpr uint32_t P1 = 2013265921, P2 = 469762049, P3 = 754974721;
+        constexpr uint64_t P1_INVERSE_MOD_P2 = 163395495;
+        constexpr uint64_t P1P2_INVERSE_MOD_P3 = 666154164;
+        constexpr uint64_t P1P2 = uint64_t(P1) * P2;
+        constexpr size_t PIECES = sizeof(Group) / sizeof(uint32_t);
+        constexpr uint64_t PIECE_MASK = 0xffffffff;
+
+        auto length = size_t(1);
+        while (length < (an + bn) * PIECES) {
+            length <<= 1;
         }
-        size_t i = 0;
-        for (i = 0; i < rhs.data.size(); ++i) {
-            DoubleGroup result = op(data[i], rhs.data[i], carry);
-            data[i] = result;
-            carry = (result >> GROUP_BIT_SIZE) > 0;
+        auto squaring = a == b && an == bn;
+        NttVector a_pieces(length, 0), b_pieces;
+        for (size_t i = 0; i < an * PIECES; ++i) {
+            a_pieces[i] = a[i / PIECES] >> (32 * (i % PIECES));
         }
-        while (i < data.size() && carry != 0) {
-            DoubleGroup result = op(data[i], 0, carry);
-            data[i] = result;
-            carry = (result >> GROUP_BIT_SIZE) > 0;
-            ++i;
+        if (!squaring) {
+            b_pieces.resize(length, 0);
+            for (size_t i = 0; i < bn * PIECES; ++i) {
+                b_pieces[i] = b[i / PIECES] >> (32 * (i % PIECES));
+            }
         }
-        return carry;
-    }
 
-    inline void BigInt::add(const BigInt& rhs) {
-        auto carry = carryOn(rhs, 0, [](Group lhs, Group rhs, DoubleGroup c) {
-            return c + lhs + rhs;
-        });
-        if (carry > 0) {
-            data.push_back(carry);
-        }
-    }
+        auto other = squaring ? nullptr : &b_pieces;
+        auto r1 = a_pieces;
+        auto r2 = a_pieces;
+        auto& r3 = a_pieces;
+        nttConvolution<P1, 31>(r1, other);
+        nttConvolution<P2, 3>(r2, other);
+        nttConvolution<P3, 11>(r3, other);
 
-    inline void BigInt::sub(const BigInt& rhs) {
-        auto carry = carryOn(rhs, 1, [](Group lhs, Group rhs, DoubleGroup c) {
-            return c + lhs + ~rhs;
-        });
-        if (carry == 0) {
-            twoComplement(data, GROUP_MAX);
-            signal = NEGATIVE;
-        } else {
-            signal = POSITIVE;
+        std::fill(r, r + an + bn, 0);
+        uint64_t carry_low = 0, carry_high = 0;
+        for (size_t i = 0; i < (an + bn) * PIECES; ++i) {
+            uint64_t x1 = r1[i];
+            uint64_t x2 = (r2[i] + P2 - x1 % P2) * P1_INVERSE_MOD_P2 % P2;
+            uint64_t partial = x1 + x2 * P1;
+            uint64_t x3 = (r3[i] + P3 - partial % P3) * P1P2_INVERSE_MOD_P3 % P3;
+            // value = partial + x3 * P1P2, accumulated in (low, high)
+            uint64_t low = partial, high = 0;
+            uint64_t term = x3 * (P1P2 & PIECE_MASK);
+            low += term;
+            high += low < term;
+            term = x3 * (P1P2 >> 32);
+            low += term << 32;
+            high += (low < (term << 32)) + (term >> 32);
+            low += carry_low;
+            high += (low < carry_low) + carry_high;
+            r[i / PIECES] |= Group(low & PIECE_MASK) << (32 * (i % PIECES));
+            carry_low = (low >> 32) | (high << 32);
+            carry_high = high >> 32;
         }
     }
 
-    void BigInt::longMult(const BigInt& rhs) {
-        auto product = GroupVector(data.size() + rhs.data.size() + 1, 0);
-        for (size_t i = 0; i < rhs.data.size(); ++i) {
-            DoubleGroup carry = 0;
-            for (size_t j = 0; j < data.size(); ++j) {
-                DoubleGroup result = rhs.data[i];
-                result = product[i + j] + result * data[j] + carry;
-                product[i + j] = result;
-                carry = result >> GROUP_BIT_SIZE;
+    // Sets *this to lhs * rhs, reusing its storage. The product is built
+    // in place unless *this is one of the operands, in which case it goes
+    // through a scratch buffer first.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::mult(const BasicBigInt& lhs,
+                                            const BasicBigInt& rhs) {
+        detail::ScratchFrame frame;
+        auto& a = lhs.data.size() >= rhs.data.size() ? lhs : rhs;
+        auto& b = &a == &lhs ? rhs : lhs;
+        auto length = a.data.size() + b.data.size();
+        auto sign = lhs.signal != rhs.signal;
+        // The product goes straight into data when it has room for every
+        // group and is no operand. Otherwise it is computed aside and
+        // only its significant groups are copied, so a product that fits
+        // in the inline groups stays there.
+        auto multiply = [&](Group* r) {
+            Scratch::multGroups(r, a.data.data(), a.data.size(),
+                                b.data.data(), b.data.size());
+        };
+        auto keep = [&](const Group* product) {
+            auto n = length;
+            while (n > 1 && product[n - 1] == 0) {
+                --n;
             }
-            product[data.size() + i] += carry;
+            data.assign(product, product + n);
+        };
+        if (this != &lhs && this != &rhs && length <= data.capacity()) {
+            data.clear();
+            data.resize(length, 0);
+            multiply(data.data());
+        } else if (length <= 2 * INLINE_GROUPS) {
+            Group product[2 * INLINE_GROUPS] = {};
+            multiply(product);
+            keep(product);
+        } else {
+            ScratchVector product(length, 0);
+            multiply(product.data());
+            keep(product.data());
+        }
+        signal = sign;
+        shrink();
+        if (isZero()) {
+            signal = POSITIVE;
         }
-        signal = signal != rhs.signal;
-        data = product;
     }
 
-    inline BigInt& BigInt::operator+=(const BigInt& rhs) {
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>&
+    BasicBigInt<Limb, Allocator>::operator+=(const BasicBigInt& rhs) {
         if (signal == rhs.signal) {
             add(rhs);
         } else {
             sub(rhs);
-            signal = !signal;
         }
         shrink(); // Is it worth?
+        if (isZero()) {
+            signal = POSITIVE;
+        }
         return *this;
     }
 
-    inline BigInt& BigInt::operator-=(const BigInt& rhs) {
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>&
+    BasicBigInt<Limb, Allocator>::operator-=(const BasicBigInt& rhs) {
         if (signal == rhs.signal) {
             sub(rhs);
         } else {
             add(rhs);
         }
         shrink(); // Is it worth?
+        if (isZero()) {
+            signal = POSITIVE;
+        }
         return *this;
     }
 
-    inline BigInt BigInt::operator-() const {
-        BigInt result = *this;
-        result.signal = !signal;
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    BasicBigInt<Limb, Allocator>::operator-() const& {
+        BasicBigInt result = *this;
+        result.signal = !signal && !isZero();
         return result;
     }
 
-    inline BigInt operator+(const BigInt& lhs, const BigInt& rhs) {
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator> BasicBigInt<Limb, Allocator>::operator-() && {
+        signal = !signal && !isZero();
+        return std::move(*this);
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator+(const BasicBigInt<Limb, Allocator>& lhs,
+              const BasicBigInt<Limb, Allocator>& rhs) {
         auto copy = lhs;
-        return copy += rhs;
+        copy += rhs;
+        return copy;
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator+(BasicBigInt<Limb, Allocator>&& lhs,
+              const BasicBigInt<Limb, Allocator>& rhs) {
+        lhs += rhs;
+        return std::move(lhs);
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator+(const BasicBigInt<Limb, Allocator>& lhs,
+              BasicBigInt<Limb, Allocator>&& rhs) {
+        rhs += lhs;
+        return std::move(rhs);
     }
 
-    inline BigInt operator-(const BigInt& lhs, const BigInt& rhs) {
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator> operator+(BasicBigInt<Limb, Allocator>&& lhs,
+                                           BasicBigInt<Limb, Allocator>&& rhs) {
+        lhs += rhs;
+        return std::move(lhs);
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator-(const BasicBigInt<Limb, Allocator>& lhs,
+              const BasicBigInt<Limb, Allocator>& rhs) {
         auto copy = lhs;
-        return copy -= rhs;
+        copy -= rhs;
+        return copy;
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator-(BasicBigInt<Limb, Allocator>&& lhs,
+              const BasicBigInt<Limb, Allocator>& rhs) {
+        lhs -= rhs;
+        return std::move(lhs);
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator-(const BasicBigInt<Limb, Allocator>& lhs,
+              BasicBigInt<Limb, Allocator>&& rhs) {
+        // lhs - rhs == -(rhs - lhs), computed in the buffer of rhs
+        rhs -= lhs;
+        if (!rhs.isZero()) {
+            rhs.signal = !rhs.signal;
+        }
+        return std::move(rhs);
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator> operator-(BasicBigInt<Limb, Allocator>&& lhs,
+                                           BasicBigInt<Limb, Allocator>&& rhs) {
+        lhs -= rhs;
+        return std::move(lhs);
     }
 
-    inline BigInt& BigInt::operator*=(const BigInt& rhs) {
-        longMult(rhs);
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>& BasicBigInt<Limb, Allocator>::square() {
+        detail::ScratchFrame frame;
+        ScratchVector product(2 * data.size(), 0);
+        Scratch::squareGroups(product.data(), data.data(), data.size());
+        signal = POSITIVE;
+        data.assign(product.begin(), product.end());
         shrink();
         return *this;
     }
 
-    inline BigInt operator*(const BigInt& lhs, const BigInt& rhs) {
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>&
+    BasicBigInt<Limb, Allocator>::operator*=(const BasicBigInt& rhs) {
+        if (&rhs == this) {
+            return square();
+        }
+        mult(*this, rhs);
+        return *this;
+    }
+
+    // Truncating division: the quotient rounds toward zero and the
+    // remainder, if any, takes the sign of the dividend. Passing this
+    // object as the remainder keeps only the remainder, in place.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::divide(const BasicBigInt& divisor,
+                                              BasicBigInt* remainder) {
+        if (divisor.isZero()) {
+            throw std::runtime_error("BigInt division by zero");
+        }
+        detail::ScratchFrame frame;
+        auto n = data.size();
+        auto m = divisor.data.size();
+        if (compareGroups(data.data(), n, divisor.data.data(), m) < 0) {
+            if (remainder == this) {
+                return;
+            }
+            if (remainder) {
+                *remainder = std::move(*this);
+            }
+            *this = BasicBigInt(get_allocator());
+            return;
+        }
+        auto& limits = thresholds();
+        auto limit = std::max(limits.burnikelZiegler, size_t(2));
+        auto quotient = ScratchVector(n - m + 1, 0);
+        auto rest = ScratchVector(m, 0);
+        if (m < limit || n - m < limit) {
+            divGroups(quotient.data(), rest.data(), data.data(), n,
+                      divisor.data.data(), m);
+        } else {
+            Scratch::divLarge(data.data(), n, divisor.data.data(), m,
+                              quotient, rest);
+        }
+        auto sign = signal;
+        if (remainder != this) {
+            signal = signal != divisor.signal;
+            data.assign(quotient.begin(), quotient.end());
+            shrink();
+            if (isZero()) {
+                signal = POSITIVE;
+            }
+        }
+        if (remainder) {
+            remainder->data.assign(rest.begin(), rest.end());
+            remainder->shrink();
+            remainder->signal = sign && !remainder->isZero();
+        }
+    }
+
+    template<typename Limb, typename Allocator>
+    int BasicBigInt<Limb, Allocator>::leadingZeros(Group group) {
+        auto count = 0;
+        for (; !(group >> (GROUP_BIT_SIZE - 1)); group <<= 1) {
+            ++count;
+        }
+        return count;
+    }
+
+    // Divides the magnitudes of a and b, which has at least as many
+    // groups as the Burnikel-Ziegler threshold. The dividend is consumed
+    // in blocks of as many groups as the divisor, each one a 2n-by-n
+    // division done either recursively or, past the Newton threshold,
+    // by multiplying with a precomputed reciprocal.
+    template<typename Limb, typename Allocator>
+    void BasicBigInt<Limb, Allocator>::divLarge(const Group* a, size_t an,
+                                                const Group* b, size_t bn,
+                                                ScratchVector& quotient,
+                                                ScratchVector& rest) {
+        auto shift = leadingZeros(b[bn - 1]);
+        auto dividend = fromGroups(a, an, 0, an);
+        auto divisor = fromGroups(b, bn, 0, bn);
+        dividend <<= shift;
+        divisor <<= shift;
+
+        auto n = dividend.data.size();
+        auto m = divisor.data.size();
+        auto use_newton = m >= std::max(thresholds().newton, size_t(2));
+        Scratch inverse;
+        if (use_newton) {
+            inverse = reciprocal(divisor, m * GROUP_BIT_SIZE);
+        }
+
+        std::fill(quotient.begin(), quotient.end(), 0);
+        Scratch remainder;
+        for (auto offset = (n - 1) / m * m; ; offset -= m) {
+            remainder <<= m * GROUP_BIT_SIZE;
+            remainder += fromGroups(dividend.data.data(), n, offset, m);
+            auto digit = use_newton
+                ? divBarrett(remainder, divisor, inverse, m)
+                : div2n1n(remainder, divisor, m);
+            addInto(quotient.data(), quotient.size(), offset, digit);
+            if (offset == 0) {
+                break;
+            }
+        }
+        remainder >>= shift;
+        std::fill(rest.begin(), rest.end(), 0);
+        std::copy(remainder.data.begin(), remainder.data.end(), rest.begin());
+    }
+
+    // Quotient of a / b, replacing a with the remainder.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Scratch
+    BasicBigInt<Limb, Allocator>::divSchoolbook(Scratch& a, const Scratch& b) {
+        auto n = a.data.size();
+        auto m = b.data.size();
+        Scratch quotient;
+        if (compareGroups(a.data.data(), n, b.data.data(), m) < 0) {
+            return quotient;
+        }
+        auto rest = ScratchVector(m, 0);
+        quotient.data.resize(n - m + 1);
+        divGroups(quotient.data.data(), rest.data(), a.data.data(), n,
+                  b.data.data(), m);
+        quotient.shrink();
+        a.data = std::move(rest);
+        a.shrink();
+        return quotient;
+    }
+
+    // Burnikel-Ziegler recursive division of a < b * B^n, B being the
+    // group radix, by the normalized n-group b, replacing a with the
+    // remainder.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Scratch
+    BasicBigInt<Limb, Allocator>::div2n1n(Scratch& a, const Scratch& b,
+                                          size_t n) {
+        if (n < std::max(thresholds().burnikelZiegler, size_t(2))) {
+            return divSchoolbook(a, b);
+        }
+        if (n % 2 == 1) {
+            // Pads a group so that the halves are even
+            auto padded = b;
+            padded <<= GROUP_BIT_SIZE;
+            a <<= GROUP_BIT_SIZE;
+            auto quotient = div2n1n(a, padded, n + 1);
+            a >>= GROUP_BIT_SIZE;
+            return quotient;
+        }
+        auto half = n / 2;
+        auto b1 = fromGroups(b.data.data(), n, half, half);
+        auto b2 = fromGroups(b.data.data(), n, 0, half);
+        auto size = a.data.size();
+        auto low = fromGroups(a.data.data(), size, 0, half);
+        auto middle = fromGroups(a.data.data(), size, half, half);
+        a = fromGroups(a.data.data(), size, n, n);
+        auto quotient = div3n2n(a, middle, b, b1, b2, half);
+        quotient <<= half * GROUP_BIT_SIZE;
+        quotient += div3n2n(a, low, b, b1, b2, half);
+        return quotient;
+    }
+
+    // Divides a12 * B^n + a3 by b = b1 * B^n + b2, replacing
+    // a12 with the remainder.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Scratch
+    BasicBigInt<Limb, Allocator>::div3n2n(Scratch& a12, const Scratch& a3,
+                                          const Scratch& b, const Scratch& b1,
+                                          const Scratch& b2, size_t n) {
+        auto size = a12.data.size();
+        auto top = fromGroups(a12.data.data(), size, n, size);
+        Scratch quotient;
+        if (compareGroups(top.data.data(), top.data.size(),
+                          b1.data.data(), b1.data.size()) == 0) {
+            // The quotient would overflow n groups, so it saturates
+            quotient.data.resize(n);
+            std::fill(quotient.data.begin(), quotient.data.end(), GROUP_MAX);
+            auto shifted = b1;
+            shifted <<= n * GROUP_BIT_SIZE;
+            a12 -= shifted;
+            a12 += b1;
+        } else {
+            quotient = div2n1n(a12, b1, n);
+        }
+        a12 <<= n * GROUP_BIT_SIZE;
+        a12 += a3;
+        auto product = quotient;
+        product *= b2;
+        a12 -= product;
+        while (a12.signal == NEGATIVE) {
+            quotient -= 1;
+            a12 += b;
+        }
+        return quotient;
+    }
+
+    // Barrett division of x < b * B^n by the normalized n-group b,
+    // given v at most floor(B^(2n) / b). The estimate only falls short
+    // by a few units. Replaces x with the remainder.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Scratch
+    BasicBigInt<Limb, Allocator>::divBarrett(Scratch& x, const Scratch& b,
+                                             const Scratch& v, size_t n) {
+        auto bits = n * GROUP_BIT_SIZE;
+        auto quotient = x;
+        quotient >>= bits - 1;
+        quotient *= v;
+        quotient >>= bits + 1;
+        auto product = quotient;
+        product *= b;
+        x -= product;
+        while (compareGroups(x.data.data(), x.data.size(),
+                             b.data.data(), b.data.size()) >= 0) {
+            x -= b;
+            quotient += 1;
+        }
+        return quotient;
+    }
+
+    // floor(2^(2 * bits) / b), for 2^(bits - 1) <= b < 2^bits, less at
+    // most a few units. Each Newton step doubles the precision of the
+    // reciprocal of the top half of b, keeping only the products that
+    // reach the result.
+    template<typename Limb, typename Allocator>
+    typename BasicBigInt<Limb, Allocator>::Scratch
+    BasicBigInt<Limb, Allocator>::reciprocal(const Scratch& b, size_t bits) {
+        auto limit = std::max(thresholds().burnikelZiegler, size_t(2));
+        if (bits <= 2 * limit * GROUP_BIT_SIZE) {
+            Scratch power = 1;
+            power <<= 2 * bits;
+            return divSchoolbook(power, b);
+        }
+        auto high_bits = bits / 2 + 8;
+        auto shift = bits - high_bits;
+        auto high = b;
+        high >>= shift;
+        auto inverse = reciprocal(high, high_bits);
+
+        // v = v0 + v0 * (2^(2 * bits) - b * v0) / 2^(2 * bits), with
+        // v0 = inverse * 2^shift, which never exceeds 1 / b. The two
+        // truncating shifts may round a negative correction up by a unit
+        // each, so the result is lowered by two.
+        Scratch error = 1;
+        error <<= bits + high_bits;
+        auto product = b;
+        product *= inverse;
+        error -= product;
+        error >>= high_bits - 2;
+        error *= inverse;
+        error >>= high_bits + 2;
+        auto result = inverse;
+        result <<= shift;
+        result += error;
+        result -= 2;
+        return result;
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>&
+    BasicBigInt<Limb, Allocator>::operator/=(const BasicBigInt& rhs) {
+        divide(rhs, nullptr);
+        return *this;
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>&
+    BasicBigInt<Limb, Allocator>::operator%=(const BasicBigInt& rhs) {
+        divide(rhs, this);
+        return *this;
+    }
+
+    template<typename Limb, typename Allocator>
+    std::pair<BasicBigInt<Limb, Allocator>, BasicBigInt<Limb, Allocator>>
+    divmod(const BasicBigInt<Limb, Allocator>& lhs,
+           const BasicBigInt<Limb, Allocator>& rhs) {
+        auto quotient = lhs;
+        BasicBigInt<Limb, Allocator> remainder(quotient.get_allocator());
+        quotient.divide(rhs, &remainder);
+        return {std::move(quotient), std::move(remainder)};
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator*(const BasicBigInt<Limb, Allocator>& lhs,
+              const BasicBigInt<Limb, Allocator>& rhs) {
+        if (&lhs == &rhs) {
+            auto copy = lhs;
+            copy.square();
+            return copy;
+        }
+        // Straight into a fresh value, without copying either operand
+        BasicBigInt<Limb, Allocator> product(lhs.get_allocator());
+        product.mult(lhs, rhs);
+        return product;
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator*(BasicBigInt<Limb, Allocator>&& lhs,
+              const BasicBigInt<Limb, Allocator>& rhs) {
+        lhs *= rhs;
+        return std::move(lhs);
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator*(const BasicBigInt<Limb, Allocator>& lhs,
+              BasicBigInt<Limb, Allocator>&& rhs) {
+        rhs *= lhs;
+        return std::move(rhs);
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator> operator*(BasicBigInt<Limb, Allocator>&& lhs,
+                                           BasicBigInt<Limb, Allocator>&& rhs) {
+        lhs *= rhs;
+        return std::move(lhs);
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator/(const BasicBigInt<Limb, Allocator>& lhs,
+              const BasicBigInt<Limb, Allocator>& rhs) {
+        auto copy = lhs;
+        copy /= rhs;
+        return copy;
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator/(BasicBigInt<Limb, Allocator>&& lhs,
+              const BasicBigInt<Limb, Allocator>& rhs) {
+        lhs /= rhs;
+        return std::move(lhs);
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator%(const BasicBigInt<Limb, Allocator>& lhs,
+              const BasicBigInt<Limb, Allocator>& rhs) {
         auto copy = lhs;
-        return copy *= rhs;
+        copy %= rhs;
+        return copy;
     }
 
-    inline BigInt& BigInt::operator<<=(intmax_t shift) {
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>
+    operator%(BasicBigInt<Limb, Allocator>&& lhs,
+              const BasicBigInt<Limb, Allocator>& rhs) {
+        lhs %= rhs;
+        return std::move(lhs);
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>&
+    BasicBigInt<Limb, Allocator>::operator<<=(intmax_t shift) {
         if (shift < 0) {
             return (*this) >>= std::abs(shift);
         }
         uintmax_t group_shift = std::floor(shift / GROUP_BIT_SIZE);
+        auto length = data.size();
         data.insert(data.cbegin(), group_shift, 0);
-        shift = shift % GROUP_BIT_SIZE;        
-        auto shift_mask = ~((2 << (GROUP_BIT_SIZE - shift - 1)) - 1);
-        Group carried_bits = 0;
-        for (auto& digit : data) {
-            auto shifted_bits = (digit & shift_mask) >> (GROUP_BIT_SIZE - shift);
-            digit = (digit << shift) | carried_bits;
-            carried_bits = shifted_bits;
-        }
-        if (carried_bits > 0) {
-            data.emplace_back(carried_bits);
+        shift = shift % GROUP_BIT_SIZE;
+        if (shift > 0) {
+            auto groups = data.data() + group_shift;
+            auto carried_bits = detail::groupKernels<Group>().shiftLeft(
+                groups, groups, length, shift);
+            if (carried_bits > 0) {
+                data.emplace_back(carried_bits);
+            }
         }
         shrink(); // Is it worth?
         return *this;
     };
 
-    inline BigInt& BigInt::operator>>=(intmax_t shift) {
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator>&
+    BasicBigInt<Limb, Allocator>::operator>>=(intmax_t shift) {
         if (shift < 0) {
             return (*this) <<= std::abs(shift);
         }
         uintmax_t group_shift = std::floor(shift / GROUP_BIT_SIZE);
         shift = shift % GROUP_BIT_SIZE;
-        auto shift_mask = (1 << shift) - 1;
-        if (group_shift > data.size()) {
+        if (group_shift >= data.size()) {
             data.clear();
             data.emplace_back(signal);
             return *this;
         }
-        for (size_t i = 0; i < group_shift; ++i) {
-            data.pop_front();
-        }
-        Group carried_bits = 0;
-        for (intmax_t i = data.size() - 1; i >= 0; --i) {
-            auto shifted_bits = data[i] & shift_mask;
-            data[i] = (data[i] >> shift) | carried_bits;
-            carried_bits = shifted_bits << (GROUP_BIT_SIZE - shift);
+        data.erase(data.begin(), data.begin() + group_shift);
+        if (shift > 0) {
+            detail::groupKernels<Group>().shiftRight(data.data(), data.data(),
+                                                     data.size(), shift);
         }
         shrink(); // Is it worth?
         if (signal && data.size() == 1 && data.back() == 0) {
@@ -326,17 +3743,158 @@ namespace hausp {
         return *this;
     };
 
-    inline BigInt operator<<(const BigInt& lhs, uintmax_t rhs) {
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator> operator<<(const BasicBigInt<Limb,
+                                            Allocator>& lhs, uintmax_t rhs) {
         auto result = lhs;
-        return result <<= rhs;
+        result <<= rhs;
+        return result;
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator> operator<<(BasicBigInt<Limb, Allocator>&& lhs,
+                                            uintmax_t rhs) {
+        lhs <<= rhs;
+        return std::move(lhs);
     }
 
-    inline BigInt operator>>(const BigInt& lhs, uintmax_t rhs) {
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator> operator>>(const BasicBigInt<Limb,
+                                            Allocator>& lhs, uintmax_t rhs) {
         auto result = lhs;
-        return result >>= rhs;
+        result >>= rhs;
+        return result;
+    }
+
+    template<typename Limb, typename Allocator>
+    BasicBigInt<Limb, Allocator> operator>>(BasicBigInt<Limb, Allocator>&& lhs,
+                                            uintmax_t rhs) {
+        lhs >>= rhs;
+        return std::move(lhs);
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator+(const BasicBigInt<Limb,
+                                           Allocator>& lhs, T rhs) {
+        auto copy = lhs;
+        copy += rhs;
+        return copy;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator+(BasicBigInt<Limb, Allocator>&& lhs,
+                                           T rhs) {
+        lhs += rhs;
+        return std::move(lhs);
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator+(T lhs, const BasicBigInt<Limb,
+                                           Allocator>& rhs) {
+        auto copy = rhs;
+        copy += lhs;
+        return copy;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator+(T lhs, BasicBigInt<Limb,
+                                           Allocator>&& rhs) {
+        rhs += lhs;
+        return std::move(rhs);
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator-(const BasicBigInt<Limb,
+                                           Allocator>& lhs, T rhs) {
+        auto copy = lhs;
+        copy -= rhs;
+        return copy;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator-(BasicBigInt<Limb, Allocator>&& lhs,
+                                           T rhs) {
+        lhs -= rhs;
+        return std::move(lhs);
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator*(const BasicBigInt<Limb,
+                                           Allocator>& lhs, T rhs) {
+        auto copy = lhs;
+        copy *= rhs;
+        return copy;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator*(BasicBigInt<Limb, Allocator>&& lhs,
+                                           T rhs) {
+        lhs *= rhs;
+        return std::move(lhs);
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator*(T lhs, const BasicBigInt<Limb,
+                                           Allocator>& rhs) {
+        auto copy = rhs;
+        copy *= lhs;
+        return copy;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator*(T lhs, BasicBigInt<Limb,
+                                           Allocator>&& rhs) {
+        rhs *= lhs;
+        return std::move(rhs);
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator/(const BasicBigInt<Limb,
+                                           Allocator>& lhs, T rhs) {
+        auto copy = lhs;
+        copy /= rhs;
+        return copy;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator/(BasicBigInt<Limb, Allocator>&& lhs,
+                                           T rhs) {
+        lhs /= rhs;
+        return std::move(lhs);
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator%(const BasicBigInt<Limb,
+                                           Allocator>& lhs, T rhs) {
+        auto copy = lhs;
+        copy %= rhs;
+        return copy;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator%(BasicBigInt<Limb, Allocator>&& lhs,
+                                           T rhs) {
+        lhs %= rhs;
+        return std::move(lhs);
     }
 
-    inline bool operator==(const BigInt& lhs, const BigInt& rhs) {
+    template<typename Limb, typename Allocator>
+    bool operator==(const BasicBigInt<Limb, Allocator>& lhs,
+                    const BasicBigInt<Limb, Allocator>& rhs) {
         if (lhs.signal != rhs.signal) {
             return false;
         } else if (lhs.data.size() == rhs.data.size()) {
@@ -347,11 +3905,15 @@ namespace hausp {
         return false;
     }
 
-    inline bool operator!=(const BigInt& lhs, const BigInt rhs) {
+    template<typename Limb, typename Allocator>
+    bool operator!=(const BasicBigInt<Limb, Allocator>& lhs,
+                    const BasicBigInt<Limb, Allocator>& rhs) {
         return !(lhs == rhs);
     }
 
-    inline bool operator<(const BigInt& lhs, const BigInt& rhs) {
+    template<typename Limb, typename Allocator>
+    bool operator<(const BasicBigInt<Limb, Allocator>& lhs,
+                   const BasicBigInt<Limb, Allocator>& rhs) {
         if (lhs.signal != rhs.signal) {
             return lhs.signal;
         } else if (lhs.data.size() == rhs.data.size()) {
@@ -362,39 +3924,298 @@ namespace hausp {
         return lhs.data.size() < rhs.data.size();
     }
 
-    inline bool operator>(const BigInt& lhs, const BigInt& rhs) {
+    template<typename Limb, typename Allocator>
+    bool operator>(const BasicBigInt<Limb, Allocator>& lhs,
+                   const BasicBigInt<Limb, Allocator>& rhs) {
         return rhs < lhs;
     }
 
-    inline bool operator<=(const BigInt& lhs, const BigInt& rhs) {
+    template<typename Limb, typename Allocator>
+    bool operator<=(const BasicBigInt<Limb, Allocator>& lhs,
+                    const BasicBigInt<Limb, Allocator>& rhs) {
         return !(lhs > rhs);
     }
 
-    inline bool operator>=(const BigInt& lhs, const BigInt& rhs) {
+    template<typename Limb, typename Allocator>
+    bool operator>=(const BasicBigInt<Limb, Allocator>& lhs,
+                    const BasicBigInt<Limb, Allocator>& rhs) {
         return !(lhs < rhs);
     }
 
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator-(T lhs, const BasicBigInt<Limb,
+                                           Allocator>& rhs) {
+        auto copy = -rhs;
+        copy += lhs;
+        return copy;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator-(T lhs, BasicBigInt<Limb,
+                                           Allocator>&& rhs) {
+        auto result = -std::move(rhs);
+        result += lhs;
+        return result;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator/(T lhs, const BasicBigInt<Limb,
+                                           Allocator>& rhs) {
+        return BasicBigInt<Limb, Allocator>(lhs, rhs.get_allocator()) / rhs;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    BasicBigInt<Limb, Allocator> operator%(T lhs, const BasicBigInt<Limb,
+                                           Allocator>& rhs) {
+        return BasicBigInt<Limb, Allocator>(lhs, rhs.get_allocator()) % rhs;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    bool operator==(const BasicBigInt<Limb, Allocator>& lhs, T rhs) {
+        return lhs == BasicBigInt<Limb, Allocator>(rhs, lhs.get_allocator());
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    bool operator==(T lhs, const BasicBigInt<Limb, Allocator>& rhs) {
+        return BasicBigInt<Limb, Allocator>(lhs, rhs.get_allocator()) == rhs;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    bool operator!=(const BasicBigInt<Limb, Allocator>& lhs, T rhs) {
+        return lhs != BasicBigInt<Limb, Allocator>(rhs, lhs.get_allocator());
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    bool operator!=(T lhs, const BasicBigInt<Limb, Allocator>& rhs) {
+        return BasicBigInt<Limb, Allocator>(lhs, rhs.get_allocator()) != rhs;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    bool operator<(const BasicBigInt<Limb, Allocator>& lhs, T rhs) {
+        return lhs < BasicBigInt<Limb, Allocator>(rhs, lhs.get_allocator());
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    bool operator<(T lhs, const BasicBigInt<Limb, Allocator>& rhs) {
+        return BasicBigInt<Limb, Allocator>(lhs, rhs.get_allocator()) < rhs;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    bool operator>(const BasicBigInt<Limb, Allocator>& lhs, T rhs) {
+        return lhs > BasicBigInt<Limb, Allocator>(rhs, lhs.get_allocator());
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    bool operator>(T lhs, const BasicBigInt<Limb, Allocator>& rhs) {
+        return BasicBigInt<Limb, Allocator>(lhs, rhs.get_allocator()) > rhs;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    bool operator<=(const BasicBigInt<Limb, Allocator>& lhs, T rhs) {
+        return lhs <= BasicBigInt<Limb, Allocator>(rhs, lhs.get_allocator());
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    bool operator<=(T lhs, const BasicBigInt<Limb, Allocator>& rhs) {
+        return BasicBigInt<Limb, Allocator>(lhs, rhs.get_allocator()) <= rhs;
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    bool operator>=(const BasicBigInt<Limb, Allocator>& lhs, T rhs) {
+        return lhs >= BasicBigInt<Limb, Allocator>(rhs, lhs.get_allocator());
+    }
+
+    template<typename Limb, typename Allocator, typename T,
+             std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    bool operator>=(T lhs, const BasicBigInt<Limb, Allocator>& rhs) {
+        return BasicBigInt<Limb, Allocator>(lhs, rhs.get_allocator()) >= rhs;
+    }
+
     template<typename... Args>
     BigInt stobi(Args&&... args) {
         return BigInt::fromString(std::forward<Args>(args)...);
     }
 
-    inline std::ostream& operator<<(std::ostream& out, const BigInt& number) {
-        auto dec_data = number.toDecimal();
-        if (number.signal == BigInt::NEGATIVE) out << "-";
-        auto last = dec_data.size() - 1;
-        for (size_t i = last + 1; i > 0; --i) {
-            auto index = i - 1;
-            auto fragment = std::to_string(dec_data[index]);
-            if (index != last) {
-                while (fragment.size() < 9) {
-                    fragment.insert(0, 1, '0');
+    // Writes value to [first, last) in the manner of std::to_chars, in
+    // any base from 2 to 36. Powers of two are unpacked bit by bit and
+    // small values of other bases are converted entirely in stack buffers.
+    // Larger values are split in scratch copies drawn from the scratch
+    // arena of the calling thread, never from the allocator of value, so
+    // the heap is only touched while that arena grows to the largest size
+    // converted so far; such a conversion may also extend the shared cache
+    // of powers, which prewarmPowers builds ahead of time.
+    template<typename Limb, typename Allocator>
+    std::to_chars_result to_chars(char* first, char* last,
+                                  const BasicBigInt<Limb, Allocator>& value,
+                                  int base) {
+        using Number = BasicBigInt<Limb, Allocator>;
+        using Group = typename Number::Group;
+        constexpr auto SMALL = Number::SMALL_CONVERSION_GROUPS;
+        if (base < 2 || base > 36) {
+            return {first, std::errc::invalid_argument};
+        }
+        size_t length = value.signal == Number::NEGATIVE;
+        if (auto bits = Number::powerOfTwo(base)) {
+            auto digits = std::max((value.bitLength() + bits - 1) / bits,
+                                   size_t(1));
+            length += digits;
+            if (size_t(last - first) < length) {
+                return {last, std::errc::value_too_large};
+            }
+            auto position = first + length;
+            auto& data = value.data;
+            auto mask = Group(base - 1);
+            for (size_t i = 0; i < digits; ++i) {
+                auto bit = i * bits;
+                auto index = bit / Number::GROUP_BIT_SIZE;
+                auto offset = bit % Number::GROUP_BIT_SIZE;
+                auto digit = data[index] >> offset;
+                if (offset + bits > Number::GROUP_BIT_SIZE
+                    && index + 1 < data.size()) {
+                    digit |= data[index + 1] << (Number::GROUP_BIT_SIZE - offset);
+                }
+                *--position = Number::DIGIT_CHARS[digit & mask];
+            }
+            if (value.signal == Number::NEGATIVE) {
+                *first = '-';
+            }
+            return {first + length, std::errc()};
+        }
+
+        // Every fragment holds at least 27 bits, the worst being base 24
+        Group small_data[SMALL * Number::GROUP_BIT_SIZE / 27 + 1];
+        detail::ScratchFrame frame;
+        typename Number::ScratchVector fragment_data;
+        const Group* fragments = small_data;
+        size_t count = 0;
+        auto radix = Number::groupRadix(base);
+        auto digits_per_group = Number::groupDigits(base);
+        auto n = value.data.size();
+        if (n <= SMALL) {
+            Group magnitude[SMALL];
+            std::copy(value.data.begin(), value.data.end(), magnitude);
+            do {
+                small_data[count++] = Number::divGroups1(
+                    magnitude, magnitude, n, radix);
+                while (n > 1 && magnitude[n - 1] == 0) {
+                    --n;
+                }
+            } while (n > 1 || magnitude[0] != 0);
+        } else {
+            fragment_data = value.toRadix(radix);
+            fragments = fragment_data.data();
+            count = fragment_data.size();
+        }
+
+        length += digits_per_group * (count - 1);
+        auto top = fragments[count - 1];
+        do {
+            ++length;
+            top /= base;
+        } while (top > 0);
+        if (size_t(last - first) < length) {
+            return {last, std::errc::value_too_large};
+        }
+        auto end = first + length;
+        auto position = end;
+        position -= digits_per_group * (count - 1);
+        if (base == 10) {
+            Number::formatDecimal(fragments, count - 1, position);
+        } else {
+            auto text = end;
+            for (size_t i = 0; i + 1 < count; ++i) {
+                auto fragment = fragments[i];
+                for (size_t digit = 0; digit < digits_per_group; ++digit) {
+                    *--text = Number::DIGIT_CHARS[fragment % base];
+                    fragment /= base;
                 }
             }
-            out << fragment;
         }
-        return out;
+        top = fragments[count - 1];
+        do {
+            *--position = Number::DIGIT_CHARS[top % base];
+            top /= base;
+        } while (top > 0);
+        if (value.signal == Number::NEGATIVE) {
+            *first = '-';
+        }
+        return {end, std::errc()};
     }
+
+    // Reads an optional minus sign and a run of digits from [first, last)
+    // in the manner of std::from_chars, leaving value untouched on error.
+    // Letters are case insensitive and no radix prefix is accepted. The
+    // storage of value is only grown when the digits do not fit in it;
+    // long runs are joined in scratch storage, as to_chars splits them.
+    template<typename Limb, typename Allocator>
+    std::from_chars_result from_chars(const char* first, const char* last,
+                                      BasicBigInt<Limb, Allocator>& value,
+                                      int base) {
+        using Number = BasicBigInt<Limb, Allocator>;
+        if (base < 2 || base > 36) {
+            return {first, std::errc::invalid_argument};
+        }
+        auto negative = first != last && *first == '-';
+        auto digits_begin = first + negative;
+        auto digits_end = std::find_if_not(digits_begin, last, [base](char c) {
+            return Number::digitValue(c) < unsigned(base);
+        });
+        if (digits_begin == digits_end) {
+            return {first, std::errc::invalid_argument};
+        }
+        Number::readDigits({digits_begin, size_t(digits_end - digits_begin)},
+                           base, value.data);
+        value.signal = negative && !value.isZero();
+        return {digits_end, std::errc()};
+    }
+
+    template<typename Limb, typename Allocator>
+    std::ostream& operator<<(std::ostream& out,
+                             const BasicBigInt<Limb, Allocator>& number) {
+        // log10(2) < 1234 / 4096, plus room for the sign and rounding
+        std::string text(number.bitLength() * 1234 / 4096 + 2, '\0');
+        auto result = to_chars(&text[0], &text[0] + text.size(), number);
+        text.resize(result.ptr - text.data());
+        return out << text;
+    }
+
+    // Programs linked against libbigint (make lib) define
+    // HAUSP_BIGINT_LIBRARY before including this header. BigInt and its
+    // heavy non-member functions are then compiled once, in
+    // src/BigInt.cpp, instead of in every translation unit; the library
+    // must be built with the same HAUSP_BIGINT_GROUP_BITS. The scratch
+    // instantiation, where the multiplication, division and conversion
+    // algorithms of every BasicBigInt run, is compiled there too. Other
+    // instantiations of BasicBigInt stay header-only.
+#ifdef HAUSP_BIGINT_LIBRARY
+    extern template class BasicBigInt<>;
+    extern template class BasicBigInt<
+        detail::DefaultGroup, detail::ScratchAllocator<detail::DefaultGroup>>;
+    extern template std::ostream& operator<<(std::ostream&, const BigInt&);
+    extern template BigInt operator*(const BigInt&, const BigInt&);
+    extern template std::pair<BigInt, BigInt> divmod(const BigInt&,
+                                                     const BigInt&);
+    extern template std::to_chars_result to_chars(char*, char*,
+                                                  const BigInt&, int);
+    extern template std::from_chars_result from_chars(const char*,
+                                                      const char*,
+                                                      BigInt&, int);
+#endif
 }
 
 #endif /* __BIG_INT_HPP__ */
@@ -0,0 +1,14 @@
+#include "BigInt.hpp"
+
+// The compiled part of libbigint; see HAUSP_BIGINT_LIBRARY in BigInt.hpp
+namespace hausp {
+    template class BasicBigInt<>;
+    template class BasicBigInt<detail::DefaultGroup,
+                               detail::ScratchAllocator<detail::DefaultGroup>>;
+    template std::ostream& operator<<(std::ostream&, const BigInt&);
+    template BigInt operator*(const BigInt&, const BigInt&);
+    template std::pair<BigInt, BigInt> divmod(const BigInt&, const BigInt&);
+    template std::to_chars_result to_chars(char*, char*, const BigInt&, int);
+    template std::from_chars_result from_chars(const char*, const char*,
+                                               BigInt&, int);
+}
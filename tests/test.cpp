@@ -1,11 +1,36 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <memory_resource>
+#include <random>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
 #include "BigInt.hpp"
 
 class Tests : public ::testing::Test {};
 
+// Allocations made through the global operator new
+std::atomic<size_t> heapAllocations{0};
+
+void* operator new(size_t bytes) {
+    ++heapAllocations;
+    if (auto memory = std::malloc(bytes > 0 ? bytes : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
 using hausp::BigInt;
+using Thresholds = BigInt::Thresholds;
 
 const std::vector<std::string>& sampleNumbers() {
     static bool prepared = false;
@@ -34,6 +59,27 @@ inline BigInt fs(const std::string& s) {
     return BigInt::fromString(s);
 }
 
+std::string randomDigits(size_t n, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> digit('0', '9');
+    std::string digits(n, '0');
+    for (auto& c : digits) {
+        c = digit(generator);
+    }
+    digits[0] = '1' + generator() % 9;
+    return digits;
+}
+
+// The kernels of every level the running CPU can execute
+std::vector<hausp::detail::Kernels> kernelTables() {
+    std::vector<hausp::detail::Kernels> tables;
+    auto top = static_cast<int>(hausp::detail::detectCpuLevel());
+    for (int level = 0; level <= top; ++level) {
+        tables.push_back(hausp::detail::selectKernels(hausp::CpuLevel(level)));
+    }
+    return tables;
+}
+
 TEST_F(Tests, SimpleConstruction) {
     const auto& numbers = sampleNumbers();
     std::stringstream ss;
@@ -59,6 +105,24 @@ TEST_F(Tests, ExplicitSignConstruction) {
     }
 }
 
+TEST_F(Tests, StringValidation) {
+    ASSERT_EQ(fs("  42  "), 42);
+    ASSERT_EQ(fs("\t+ 42\n"), 42);
+    ASSERT_EQ(fs("- 42"), -42);
+    ASSERT_EQ(fs("-0"), BigInt(0));
+    ASSERT_EQ(hausp::stobi("123"), 123);
+    std::string_view view = "  -9876543210123 tail";
+    ASSERT_EQ(BigInt::fromString(view.substr(0, 16)), -9876543210123);
+    ASSERT_THROW(fs(""), std::runtime_error);
+    ASSERT_THROW(fs("   "), std::runtime_error);
+    ASSERT_THROW(fs("-"), std::runtime_error);
+    ASSERT_THROW(fs("+-1"), std::runtime_error);
+    ASSERT_THROW(fs("1 2"), std::runtime_error);
+    ASSERT_THROW(fs("12a"), std::runtime_error);
+    ASSERT_THROW(fs("0x12"), std::runtime_error);
+    ASSERT_THROW(BigInt::fromString(view), std::runtime_error);
+}
+
 TEST_F(Tests, Inequalities) {
     ASSERT_TRUE(
         fs("8423982138934987132893497547132978423978132") ==
@@ -161,6 +225,8 @@ TEST_F(Tests, Shifts) {
     ASSERT_EQ(BigInt(-2) >> 31, BigInt(-1));
     ASSERT_EQ(BigInt(-2) >> 999999999, BigInt(-1));
     ASSERT_EQ(BigInt(-2) << -999999999, BigInt(-1));
+    ASSERT_EQ(BigInt(5) >> 32, BigInt(0));
+    ASSERT_EQ(BigInt(-5) >> 32, BigInt(-1));
 
     ASSERT_EQ(
         a << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9 << 10
@@ -182,6 +248,16 @@ TEST_F(Tests, AddAndSub) {
         ASSERT_EQ(value - 0, value);
     }
 
+    ASSERT_EQ(BigInt(5) + BigInt(-3), BigInt(2));
+    ASSERT_EQ(BigInt(3) + BigInt(-5), BigInt(-2));
+    ASSERT_EQ(BigInt(-5) - BigInt(-3), BigInt(-2));
+    ASSERT_EQ(BigInt(-3) - BigInt(-5), BigInt(2));
+    ASSERT_EQ(BigInt(-3) + BigInt(3), BigInt(0));
+    ASSERT_EQ(BigInt(-3) - BigInt(-3), BigInt(0));
+    ASSERT_EQ(fs("159687822085") + BigInt(-1099238854), fs("158588583231"));
+    ASSERT_EQ(fs("-425919129283175395") + 1112653675, fs("-425919128170521720"));
+    ASSERT_EQ(fs("18446744073709551616") - 1, fs("18446744073709551615"));
+
     auto n1 = fs(repeat(1, 1000));
     auto n2 = fs(repeat(2, 1000));
     auto n3 = fs(repeat(3, 1000));
@@ -212,6 +288,11 @@ TEST_F(Tests, AddAndSub) {
         fs(repeat(4, 123)) + fs(repeat(5, 123)) + fs(repeat(1, 123)),
         fs(repeat(1, 123) + "0")
     );
+
+    ASSERT_EQ(n1 - (n3 - n1), -n1);
+    ASSERT_EQ(n3 - (n2 + n1), BigInt(0));
+    ASSERT_EQ((n1 - n3) + (n3 - n1), BigInt(0));
+    ASSERT_EQ(n1 + (n2 - n3), BigInt(0));
 }
 
 TEST_F(Tests, MultAndDiv) {
@@ -236,29 +317,1008 @@ TEST_F(Tests, MultAndDiv) {
     ASSERT_EQ((a + b) * (a + b), a * a + 2 * a * b + b * b);
     ASSERT_EQ((a - b) * (a - b), a * a - 2 * a * b + b * b);
 
-    // ASSERT_EQ(BigInt(3) / 2, 1);
-    // ASSERT_EQ(BigInt(-3) / 2, -1);
-    // ASSERT_EQ(BigInt(3) / -2, -1);
-    // ASSERT_EQ(BigInt(-3) / -2, 1);
-    // ASSERT_EQ(a / 1, a);
-    // ASSERT_EQ(b / 1, b);
-    // ASSERT_EQ(c / 1, c);
-    // ASSERT_EQ(a / a, 1);
-    // ASSERT_EQ(b / b, 1);
-    // ASSERT_EQ(c / c, 1);
-    // ASSERT_EQ(c / a, b);
-    // ASSERT_EQ(c / b, a);
-    // ASSERT_EQ(-c / a, -b);
-    // ASSERT_EQ(c / -b, -a);
-    // ASSERT_EQ((a + c) / a, 1 + b);
-    // ASSERT_EQ(-(a + c) / -a, 1 + b);
-    // ASSERT_EQ((a - c) / a, 1 - b);
-    // ASSERT_ANY_THROW(BigInt(1) / 0);
-    // ASSERT_ANY_THROW(BigInt(-1) / 0);
-    // ASSERT_ANY_THROW(BigInt(0) / 0);
-    // ASSERT_ANY_THROW(a / 0);
-    // ASSERT_ANY_THROW(a / (a - a));
-    // ASSERT_ANY_THROW(b / (b * a - a * b));
+    ASSERT_EQ(BigInt(0) * BigInt(-5), BigInt(0));
+    ASSERT_EQ(BigInt(-5) * BigInt(0), BigInt(0));
+
+    ASSERT_EQ(BigInt(3) / 2, 1);
+    ASSERT_EQ(BigInt(-3) / 2, -1);
+    ASSERT_EQ(BigInt(3) / -2, -1);
+    ASSERT_EQ(BigInt(-3) / -2, 1);
+    ASSERT_EQ(a / 1, a);
+    ASSERT_EQ(b / 1, b);
+    ASSERT_EQ(c / 1, c);
+    ASSERT_EQ(a / a, 1);
+    ASSERT_EQ(b / b, 1);
+    ASSERT_EQ(c / c, 1);
+    ASSERT_EQ(c / a, b);
+    ASSERT_EQ(c / b, a);
+    ASSERT_EQ(-c / a, -b);
+    ASSERT_EQ(c / -b, -a);
+    ASSERT_EQ((a + c) / a, 1 + b);
+    ASSERT_EQ(-(a + c) / -a, 1 + b);
+    ASSERT_EQ((a - c) / a, 1 - b);
+    ASSERT_ANY_THROW(BigInt(1) / 0);
+    ASSERT_ANY_THROW(BigInt(-1) / 0);
+    ASSERT_ANY_THROW(BigInt(0) / 0);
+    ASSERT_ANY_THROW(a / 0);
+    ASSERT_ANY_THROW(a / (a - a));
+    ASSERT_ANY_THROW(b / (b * a - a * b));
+}
+
+TEST_F(Tests, ScalarOps) {
+    auto a = fs("1234567890123456789012345678901234567890");
+    auto b = BigInt(a);
+
+    b += 10;
+    ASSERT_EQ(b, a + BigInt(10));
+    b -= 10;
+    ASSERT_EQ(b, a);
+    ASSERT_EQ(a + 4294967295u, a + fs("4294967295"));
+    ASSERT_EQ(a - INT64_MIN, a + fs("9223372036854775808"));
+    ASSERT_EQ(BigInt(3) - 5, -2);
+    ASSERT_EQ(BigInt(-3) + 5, 2);
+    ASSERT_EQ(BigInt(-3) + 3, 0);
+    ASSERT_EQ(-(BigInt(-3) + 3), 0);
+    ASSERT_EQ(fs("4294967296") - 1, fs("4294967295"));
+
+    ASSERT_EQ(a * 7, a * BigInt(7));
+    ASSERT_EQ(a * -7, -(a * BigInt(7)));
+    ASSERT_EQ(-7 * a, a * -7);
+    ASSERT_EQ(a * UINT64_MAX, a * fs("18446744073709551615"));
+    ASSERT_EQ(a * 0, 0);
+    ASSERT_EQ(-a * 0, BigInt(0));
+
+    ASSERT_EQ(BigInt(7) % 3, 1);
+    ASSERT_EQ(BigInt(-7) % 3, -1);
+    ASSERT_EQ(BigInt(7) % -3, 1);
+    ASSERT_EQ(BigInt(-6) % 3, 0);
+    ASSERT_EQ((a * 1000 + 999) / 1000, a);
+    ASSERT_EQ((a * 1000 + 999) % 1000, 999);
+    ASSERT_EQ((a * 12345678901234567 + 42) / 12345678901234567, a);
+    ASSERT_EQ((a * 12345678901234567 + 42) % -12345678901234567, 42);
+    ASSERT_EQ((-a * 12345678901234567 - 42) % 12345678901234567, -42);
+    ASSERT_EQ(a / UINT64_MAX, fs("66926059427634869180"));
+    ASSERT_ANY_THROW(a % 0);
+}
+
+TEST_F(Tests, Division) {
+    auto a = fs("340282366920938463463374607431768211456");
+    auto b = fs("79228162514264337593543950335");
+    ASSERT_EQ(a / b, 4294967296);
+    ASSERT_EQ(a % b, 4294967296);
+    ASSERT_EQ(-a / b, -4294967296);
+    ASSERT_EQ(-a % b, -4294967296);
+    ASSERT_EQ(a / -b, -4294967296);
+    ASSERT_EQ(a % -b, 4294967296);
+    ASSERT_EQ(b / a, 0);
+    ASSERT_EQ(b % a, b);
+    ASSERT_EQ(-b % a, -b);
+    ASSERT_EQ(a % a, 0);
+    ASSERT_EQ(-a % a, BigInt(0));
+
+    auto c = a;
+    c /= c;
+    ASSERT_EQ(c, 1);
+    c = a;
+    c %= c;
+    ASSERT_EQ(c, 0);
+    ASSERT_ANY_THROW(a % BigInt(0));
+
+    for (size_t digits : {20, 60, 300, 1000}) {
+        for (unsigned seed = 0; seed < 8; ++seed) {
+            auto x = fs(randomDigits(digits, seed));
+            auto y = fs(randomDigits(digits / 2 + seed, seed + 100));
+            if (seed % 2) {
+                x = -x;
+            }
+            if (seed % 3 == 0) {
+                y = -y;
+            }
+            auto result = divmod(x, y);
+            ASSERT_EQ(result.first * y + result.second, x);
+            ASSERT_TRUE((result.second < 0 ? -result.second : result.second)
+                        < (y < 0 ? -y : y));
+            ASSERT_TRUE(result.second == 0 || (result.second < 0) == (x < 0));
+            ASSERT_EQ(x / y, result.first);
+            ASSERT_EQ(x % y, result.second);
+            ASSERT_EQ((x * y) / y, x);
+        }
+    }
+}
+
+TEST_F(Tests, SubquadraticDivision) {
+    auto& thresholds = BigInt::thresholds();
+    auto saved = thresholds;
+    for (size_t digits : {400, 1500, 4000}) {
+        for (unsigned seed = 0; seed < 4; ++seed) {
+            auto x = fs(randomDigits(digits, seed));
+            auto y = fs(randomDigits(digits / (seed + 2), seed + 50));
+            if (seed % 2) {
+                x = -x;
+            }
+            thresholds.burnikelZiegler = SIZE_MAX;
+            auto expected = divmod(x, y);
+            for (auto limits : {std::make_pair<size_t, size_t>(4, SIZE_MAX),
+                                std::make_pair<size_t, size_t>(3, 8),
+                                std::make_pair<size_t, size_t>(2, 2)}) {
+                thresholds.burnikelZiegler = limits.first;
+                thresholds.newton = limits.second;
+                auto result = divmod(x, y);
+                ASSERT_EQ(result.first, expected.first);
+                ASSERT_EQ(result.second, expected.second);
+                ASSERT_EQ((x * y) / y, x);
+                ASSERT_EQ((x * y - 1) % y, x < 0 ? -1 : y - 1);
+            }
+            thresholds = saved;
+        }
+    }
+}
+
+TEST_F(Tests, DecimalOutput) {
+    auto& thresholds = BigInt::thresholds();
+    auto saved = thresholds;
+    std::stringstream ss;
+    for (size_t limit : {2, 8, 64}) {
+        thresholds.radixConversion = limit;
+        for (size_t digits : {1, 9, 10, 18, 19, 100, 1000, 5000}) {
+            auto text = randomDigits(digits, digits);
+            ss.str("");
+            ss << fs(text);
+            ASSERT_EQ(ss.str(), text);
+            ss.str("");
+            ss << fs("-" + text);
+            ASSERT_EQ(ss.str(), "-" + text);
+        }
+        auto power = fs("1" + std::string(2000, '0'));
+        ss.str("");
+        ss << power;
+        ASSERT_EQ(ss.str(), "1" + std::string(2000, '0'));
+        ss.str("");
+        ss << power - 1;
+        ASSERT_EQ(ss.str(), std::string(2000, '9'));
+    }
+    thresholds = saved;
+    ss.str("");
+    ss << BigInt(0) << " " << BigInt(-7) << " " << BigInt(1000000000);
+    ASSERT_EQ(ss.str(), "0 -7 1000000000");
+}
+
+TEST_F(Tests, DecimalParsing) {
+    auto& thresholds = BigInt::thresholds();
+    auto saved = thresholds;
+    auto text = randomDigits(3000, 7);
+    auto expected = fs(text);
+    BigInt power = 1;
+    for (size_t i = 0; i < 1500; ++i) {
+        power *= 10;
+    }
+    for (size_t limit : {2, 3, 16}) {
+        thresholds.radixConversion = limit;
+        ASSERT_EQ(fs(text), expected);
+        ASSERT_EQ(fs("-" + text), -expected);
+        ASSERT_EQ(fs("1" + std::string(1500, '0')), power);
+        ASSERT_EQ(fs(std::string(1500, '9')), power - 1);
+        ASSERT_EQ(fs("000000000000000000000000000042"), 42);
+    }
+    thresholds = saved;
+}
+
+TEST_F(Tests, CharConversion) {
+    char buffer[2048];
+    auto end = std::end(buffer);
+    for (size_t digits : {1, 9, 10, 100, 700, 1500}) {
+        auto text = "-" + randomDigits(digits, digits);
+        auto value = fs(text);
+        auto result = hausp::to_chars(buffer, end, value);
+        ASSERT_EQ(result.ec, std::errc());
+        ASSERT_EQ(std::string(buffer, result.ptr), text);
+
+        BigInt parsed;
+        auto parse = hausp::from_chars(buffer, result.ptr, parsed);
+        ASSERT_EQ(parse.ec, std::errc());
+        ASSERT_EQ(parse.ptr, result.ptr);
+        ASSERT_EQ(parsed, value);
+
+        result = hausp::to_chars(buffer, buffer + text.size() - 1, value);
+        ASSERT_EQ(result.ec, std::errc::value_too_large);
+    }
+
+    auto result = hausp::to_chars(buffer, end, BigInt(0));
+    ASSERT_EQ(std::string(buffer, result.ptr), "0");
+    result = hausp::to_chars(buffer, end, BigInt(1000000000));
+    ASSERT_EQ(std::string(buffer, result.ptr), "1000000000");
+
+    BigInt value = 7;
+    std::string text = "123abc";
+    auto parse = hausp::from_chars(text.data(), text.data() + text.size(), value);
+    ASSERT_EQ(parse.ptr, text.data() + 3);
+    ASSERT_EQ(value, 123);
+    text = "-0";
+    hausp::from_chars(text.data(), text.data() + text.size(), value);
+    ASSERT_EQ(value, BigInt(0));
+    for (std::string invalid : {"", "-", "+1", " 1", "abc"}) {
+        parse = hausp::from_chars(invalid.data(),
+                                  invalid.data() + invalid.size(), value);
+        ASSERT_EQ(parse.ec, std::errc::invalid_argument);
+        ASSERT_EQ(parse.ptr, invalid.data());
+        ASSERT_EQ(value, BigInt(0));
+    }
+}
+
+TEST_F(Tests, RadixConversion) {
+    auto a = fs("-1234567890123456789012345678901234567890");
+    std::vector<char> storage(12000);
+    auto buffer = storage.data();
+    auto end = buffer + storage.size();
+    auto format = [&](const BigInt& value, int base) {
+        auto result = hausp::to_chars(buffer, end, value, base);
+        EXPECT_EQ(result.ec, std::errc());
+        return std::string(buffer, result.ptr);
+    };
+    ASSERT_EQ(format(a, 16), "-3a0c92075c0dbf3b8acbc5f96ce3f0ad2");
+    ASSERT_EQ(format(a, 8), "-16406222016560155763561262742771331617605322");
+    ASSERT_EQ(format(a, 36), "-1izibjf4zvdbmvq66d6wm8g1ci");
+    ASSERT_EQ(format(BigInt(1) << 64, 36), "3w5e11264sgsg");
+    ASSERT_EQ(format(BigInt(0), 2), "0");
+    ASSERT_EQ(format(BigInt(5), 2), "101");
+    ASSERT_EQ(BigInt::fromString("-3A0C92075C0DBF3B8ACBC5F96CE3F0AD2", 16), a);
+    ASSERT_EQ(BigInt::fromString(" + 1izibjf4zvdbmvq66d6wm8g1ci ", 36), -a);
+    ASSERT_THROW(BigInt::fromString("12", 2), std::runtime_error);
+    ASSERT_THROW(BigInt::fromString("12", 37), std::runtime_error);
+    ASSERT_EQ(hausp::to_chars(buffer, end, a, 1).ec, std::errc::invalid_argument);
+
+    auto& thresholds = BigInt::thresholds();
+    auto saved = thresholds;
+    for (size_t limit : {2, 64}) {
+        thresholds.radixConversion = limit;
+        for (size_t digits : {20, 3000}) {
+            auto value = fs(randomDigits(digits, digits + 1));
+            for (int base = 2; base <= 36; ++base) {
+                auto text = format(-value, base);
+                ASSERT_EQ(BigInt::fromString(text, base), -value);
+                BigInt parsed;
+                auto result = hausp::from_chars(text.data(),
+                                                text.data() + text.size(),
+                                                parsed, base);
+                ASSERT_EQ(result.ptr, text.data() + text.size());
+                ASSERT_EQ(parsed, -value);
+            }
+        }
+    }
+    thresholds = saved;
+}
+
+TEST_F(Tests, SharedPowerCache) {
+    BigInt::prewarmPowers(20000);
+    BigInt::prewarmPowers(1000, 7);
+    std::vector<std::string> texts;
+    for (size_t digits : {500, 2000, 8000, 30000}) {
+        texts.push_back(randomDigits(digits, digits));
+    }
+    std::vector<int> matches(8, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < matches.size(); ++t) {
+        threads.emplace_back([&texts, &matches, t] {
+            auto& text = texts[t % texts.size()];
+            std::stringstream ss;
+            ss << fs(text);
+            matches[t] = ss.str() == text;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto match : matches) {
+        ASSERT_TRUE(match);
+    }
+}
+
+TEST_F(Tests, CharConversionAllocations) {
+    std::vector<char> storage(40000);
+    auto buffer = storage.data();
+    auto end = buffer + storage.size();
+
+    // Values up to the stack conversion size never touch the heap
+    for (size_t digits : {1, 30, 300}) {
+        auto value = -fs(randomDigits(digits, digits + 2));
+        BigInt parsed = value;
+        for (int base : {10, 16, 7, 36}) {
+            auto heap = heapAllocations.load();
+            auto written = hausp::to_chars(buffer, end, value, base);
+            auto read = hausp::from_chars(buffer, written.ptr, parsed, base);
+            ASSERT_EQ(heapAllocations.load(), heap);
+            ASSERT_EQ(written.ec, std::errc());
+            ASSERT_EQ(read.ptr, written.ptr);
+            ASSERT_EQ(parsed, value);
+        }
+    }
+
+    // Larger values are split and joined in the scratch arena of the
+    // thread with the shared powers, which stop growing once warmed up
+    for (size_t digits : {3000, 30000}) {
+        auto value = fs(randomDigits(digits, digits + 3));
+        BigInt parsed = value;
+        for (int base : {10, 7}) {
+            BigInt::prewarmPowers(digits, base);
+            auto written = hausp::to_chars(buffer, end, value, base);
+            hausp::from_chars(buffer, written.ptr, parsed, base);
+            auto heap = heapAllocations.load();
+            written = hausp::to_chars(buffer, end, value, base);
+            auto read = hausp::from_chars(buffer, written.ptr, parsed, base);
+            ASSERT_EQ(heapAllocations.load(), heap);
+            ASSERT_EQ(written.ec, std::errc());
+            ASSERT_EQ(read.ptr, written.ptr);
+            ASSERT_EQ(parsed, value);
+        }
+    }
+}
+
+TEST_F(Tests, DigitKernels) {
+    using namespace hausp::detail;
+    auto tables = kernelTables();
+    std::mt19937 generator(17);
+    std::uniform_int_distribution<uint32_t> fragment(0, 999999999);
+    for (size_t count = 0; count < 42; ++count) {
+        std::vector<uint32_t> values(count);
+        for (auto& value : values) {
+            value = fragment(generator);
+        }
+        if (count > 1) {
+            values[0] = 0;
+            values[1] = 999999999;
+        }
+        std::string expected(9 * count, ' ');
+        formatFragmentsScalar(values.data(), count, &expected[0]);
+        for (auto& table : tables) {
+            std::string text(9 * count, ' ');
+            table.formatFragments(values.data(), count, &text[0]);
+            ASSERT_EQ(text, expected);
+            std::vector<uint32_t> parsed(count);
+            table.parseFragments(text.data(), count, parsed.data());
+            ASSERT_EQ(parsed, values);
+        }
+    }
+}
+
+TEST_F(Tests, KaratsubaMult) {
+    auto& thresholds = BigInt::thresholds();
+    auto saved = thresholds;
+    for (size_t digits : {100, 317, 1000, 2500}) {
+        auto a = fs(randomDigits(digits, digits));
+        auto b = fs(randomDigits(digits, digits + 1));
+        auto c = fs(randomDigits(digits / 3, digits + 2));
+        auto d = fs(repeat(9, digits));
+
+        thresholds.karatsuba = SIZE_MAX;
+        auto ab = a * b;
+        auto ac = a * c;
+        auto dd = d * d;
+
+        for (size_t karatsuba : {2, 3, 5, 16}) {
+            thresholds.karatsuba = karatsuba;
+            ASSERT_EQ(a * b, ab);
+            ASSERT_EQ(b * a, ab);
+            ASSERT_EQ(a * c, ac);
+            ASSERT_EQ(c * -a, -ac);
+            ASSERT_EQ(d * d, dd);
+        }
+    }
+    thresholds = saved;
+}
+
+TEST_F(Tests, ToomMult) {
+    auto& thresholds = BigInt::thresholds();
+    auto saved = thresholds;
+    auto a = fs(randomDigits(3000, 1));
+    auto b = fs(randomDigits(2900, 2));
+    auto c = fs(randomDigits(1700, 3));
+    auto d = fs(randomDigits(600, 4));
+    auto e = fs(repeat(9, 2000));
+
+    thresholds.karatsuba = SIZE_MAX;
+    auto ab = a * b;
+    auto ac = a * c;
+    auto ad = a * d;
+    auto ee = e * e;
+
+    for (size_t toom3 : {3, 12, 40}) {
+        for (size_t toom4 : {size_t(3), size_t(20), size_t(80), SIZE_MAX}) {
+            thresholds.karatsuba = 4;
+            thresholds.toom3 = toom3;
+            thresholds.toom4 = toom4;
+            ASSERT_EQ(a * b, ab);
+            ASSERT_EQ(-b * a, -ab);
+            ASSERT_EQ(a * c, ac);
+            ASSERT_EQ(d * a, ad);
+            ASSERT_EQ(e * e, ee);
+        }
+    }
+    thresholds = saved;
+}
+
+TEST_F(Tests, NttMult) {
+    auto& thresholds = BigInt::thresholds();
+    auto saved = thresholds;
+    auto a = fs(randomDigits(5000, 5));
+    auto b = fs(randomDigits(4000, 6));
+    auto c = fs(randomDigits(30, 7));
+    auto ones = (BigInt(1) << 40000) - 1;
+
+    thresholds.ntt = SIZE_MAX;
+    auto ab = a * b;
+    auto ac = a * c;
+    auto squared_ones = ones * ones;
+
+    for (size_t ntt : {2, 64, 300}) {
+        thresholds.ntt = ntt;
+        ASSERT_EQ(a * b, ab);
+        ASSERT_EQ(b * -a, -ab);
+        ASSERT_EQ(a * c, ac);
+        ASSERT_EQ(ones * ones, squared_ones);
+        ASSERT_EQ(BigInt(3) * BigInt(5), BigInt(15));
+    }
+    thresholds = saved;
+}
+
+TEST_F(Tests, Squaring) {
+    auto& thresholds = BigInt::thresholds();
+    auto saved = thresholds;
+    std::vector<BigInt> numbers = {
+        BigInt(0), BigInt(-7), fs("-4294967295"), fs("18446744073709551615"),
+        fs(randomDigits(100, 8)), fs(randomDigits(3000, 9)),
+        (BigInt(1) << 20000) - 1
+    };
+    std::vector<BigInt> squares;
+    thresholds.karatsuba = SIZE_MAX;
+    for (auto& n : numbers) {
+        auto copy = n;
+        squares.push_back(n * copy);
+    }
+
+    Thresholds tiers[] = {
+        {4, SIZE_MAX, SIZE_MAX, SIZE_MAX},
+        {4, 8, SIZE_MAX, SIZE_MAX},
+        {4, 8, 16, SIZE_MAX},
+        {4, 8, 16, 32},
+        saved
+    };
+    for (auto& tier : tiers) {
+        thresholds = tier;
+        for (size_t i = 0; i < numbers.size(); ++i) {
+            auto n = numbers[i];
+            ASSERT_EQ(n * n, squares[i]);
+            n *= n;
+            ASSERT_EQ(n, squares[i]);
+            n = numbers[i];
+            ASSERT_EQ(n.square(), squares[i]);
+        }
+    }
+    thresholds = saved;
+}
+
+TEST_F(Tests, LimbAndAllocatorParameters) {
+    using Narrow = hausp::BasicBigInt<uint32_t>;
+    using Pooled = hausp::BasicBigInt<uint64_t,
+                                      std::pmr::polymorphic_allocator<uint64_t>>;
+    auto text = [](const auto& value) {
+        std::stringstream ss;
+        ss << value;
+        return ss.str();
+    };
+    auto a = randomDigits(3000, 10);
+    auto b = "-" + randomDigits(1400, 11);
+    auto product = text(fs(a) * fs(b));
+    auto quotient = text(fs(a) / fs(b));
+    auto remainder = text(fs(a) % fs(b));
+    auto shifted = text((fs(b) << 1000) - 7);
+
+    auto na = Narrow::fromString(a);
+    auto nb = Narrow::fromString(b);
+    ASSERT_EQ(text(na * nb), product);
+    ASSERT_EQ(text(na / nb), quotient);
+    ASSERT_EQ(text(na % nb), remainder);
+    ASSERT_EQ(text((nb << 1000) - 7), shifted);
+    ASSERT_EQ(Narrow::fromString(text(na)), na);
+
+    std::pmr::monotonic_buffer_resource arena;
+    auto previous = std::pmr::set_default_resource(&arena);
+    {
+        auto pa = Pooled::fromString(a);
+        auto pb = Pooled::fromString(b);
+        ASSERT_EQ(text(pa * pb), product);
+        ASSERT_EQ(text(pa / pb), quotient);
+        ASSERT_EQ(text(pa % pb), remainder);
+        ASSERT_EQ(text((pb << 1000) - 7), shifted);
+        ASSERT_TRUE(pa > pb && pb < 0 && 0 < pa);
+    }
+    std::pmr::set_default_resource(previous);
+}
+
+TEST_F(Tests, AllocatorAwareConstruction) {
+    using Pooled = hausp::BasicBigInt<uint64_t,
+                                      std::pmr::polymorphic_allocator<uint64_t>>;
+    auto text = [](const auto& value) {
+        std::stringstream ss;
+        ss << value;
+        return ss.str();
+    };
+    auto digits = randomDigits(800, 12);
+    auto expected = fs(digits);
+    expected *= expected;
+    expected /= 12345;
+    expected += fs("-98765432109876543210");
+    expected %= fs(randomDigits(400, 13));
+
+    std::pmr::monotonic_buffer_resource pool;
+    std::pmr::polymorphic_allocator<uint64_t> allocator(&pool);
+    auto x = Pooled::fromString(digits, 10, allocator);
+    Pooled y(12345, allocator);
+    Pooled z(Pooled::fromString("-98765432109876543210"), allocator);
+    Pooled w(Pooled::fromString(randomDigits(400, 13)), allocator);
+    x *= x;
+    x /= y;
+    x += z;
+    x %= w;
+    ASSERT_EQ(text(x), text(expected));
+    for (auto* value : {&x, &y, &z, &w}) {
+        ASSERT_EQ(value->get_allocator().resource(), &pool);
+    }
+    Pooled copy(x, allocator);
+    Pooled moved(std::move(copy), allocator);
+    ASSERT_EQ(moved, x);
+    ASSERT_EQ(moved.get_allocator().resource(), &pool);
+}
+
+// A memory resource that counts the blocks it hands out
+struct Counting : std::pmr::memory_resource {
+    size_t allocations = 0;
+    void* do_allocate(size_t bytes, size_t align) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+TEST_F(Tests, InlineStorage) {
+    using Counted = hausp::BasicBigInt<uint64_t,
+                                       std::pmr::polymorphic_allocator<uint64_t>>;
+    auto text = [](const auto& value) {
+        std::stringstream ss;
+        ss << value;
+        return ss.str();
+    };
+    Counting resource;
+    std::pmr::polymorphic_allocator<uint64_t> allocator(&resource);
+
+    // Up to two 64-bit groups, values and their temporaries stay inline
+    auto heap = heapAllocations.load();
+    Counted zero(allocator);
+    Counted a(INT64_MIN, allocator);
+    Counted b(UINT64_MAX, allocator);
+    Counted c = a + b;
+    Counted d = b * b;
+    Counted e = (b << 63) - a * 3;
+    Counted f = d;
+    f -= b;
+    f /= b;
+    BigInt g = UINT64_MAX;
+    g *= g;
+    g += 1;
+    // Two groups times one, with a product that still fits in two
+    Counted prime(1000000007, allocator);
+    Counted wide(b << 32, allocator);
+    Counted k = wide * prime;
+    wide *= prime;
+    ASSERT_EQ(resource.allocations, 0u);
+    ASSERT_EQ(heapAllocations.load(), heap);
+    ASSERT_EQ(zero, 0);
+    ASSERT_EQ(c, 9223372036854775807);
+    ASSERT_EQ(text(d), "340282366920938463426481119284349108225");
+    ASSERT_EQ(text(e), "170141183460469231750134047789593657344");
+    ASSERT_EQ(f, UINT64_MAX - 1);
+    ASSERT_EQ(text(g), "340282366920938463426481119284349108226");
+    ASSERT_EQ(text(k), text(fs("18446744073709551615") * 4294967296
+                            * 1000000007));
+    ASSERT_EQ(wide, k);
+
+    // Growing past the inline groups spills to the allocator, and
+    // shrinking back keeps the value intact
+    Counted h(d, allocator);
+    h <<= 200;
+    ASSERT_GT(resource.allocations, 0u);
+    ASSERT_EQ(text(h), text(fs("340282366920938463426481119284349108225") << 200));
+    h >>= 200;
+    ASSERT_EQ(h, d);
+    h += 1;
+    h -= b * b;
+    ASSERT_EQ(h, 1);
+    h = d * d;
+    h /= d;
+    ASSERT_EQ(h, d);
+    h = -d;
+    h += d;
+    ASSERT_EQ(h, 0);
+    ASSERT_EQ(h.get_allocator().resource(), &resource);
+}
+
+// A stateful allocator that can only be built from its resource
+template<typename T>
+struct ResourceAllocator {
+    using value_type = T;
+
+    explicit ResourceAllocator(std::pmr::memory_resource* resource):
+     resource{resource} { }
+    template<typename U>
+    ResourceAllocator(const ResourceAllocator<U>& other):
+     resource{other.resource} { }
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(resource->allocate(count * sizeof(T),
+                                                  alignof(T)));
+    }
+    void deallocate(T* memory, size_t count) {
+        resource->deallocate(memory, count * sizeof(T), alignof(T));
+    }
+    friend bool operator==(const ResourceAllocator& lhs,
+                           const ResourceAllocator& rhs) {
+        return lhs.resource == rhs.resource;
+    }
+    friend bool operator!=(const ResourceAllocator& lhs,
+                           const ResourceAllocator& rhs) {
+        return !(lhs == rhs);
+    }
+
+    std::pmr::memory_resource* resource;
+};
+
+TEST_F(Tests, AllocatorWithoutDefaultConstructor) {
+    using Bound = hausp::BasicBigInt<uint64_t, ResourceAllocator<uint64_t>>;
+    static_assert(!std::is_default_constructible<
+                  ResourceAllocator<uint64_t>>::value, "");
+    auto text = [](const auto& value) {
+        std::stringstream ss;
+        ss << value;
+        return ss.str();
+    };
+    auto a = randomDigits(9000, 33);
+    auto b = "-" + randomDigits(6000, 34);
+    auto expected_a = fs(a);
+    auto expected_b = fs(b);
+
+    std::pmr::unsynchronized_pool_resource pool;
+    ResourceAllocator<uint64_t> allocator(&pool);
+    auto x = Bound::fromString(a, 10, allocator);
+    auto y = Bound::fromString(b, 10, allocator);
+    Bound small(-7, allocator);
+    Bound zero(allocator);
+    ASSERT_EQ(text(x * y), text(expected_a * expected_b));
+    ASSERT_EQ(text(x / y), text(expected_a / expected_b));
+    ASSERT_EQ(text(x % y), text(expected_a % expected_b));
+    ASSERT_EQ(text(x + y - small), text(expected_a + expected_b + 7));
+    ASSERT_EQ(text(-(x << 100) >> 3), text(-(expected_a << 100) >> 3));
+    auto [quotient, remainder] = hausp::divmod(y, x);
+    ASSERT_EQ(text(quotient), "0");
+    ASSERT_EQ(remainder, y);
+    ASSERT_EQ(text(12345678 / small), "-1763668");
+    ASSERT_EQ(text(12345678 % small), "2");
+    ASSERT_TRUE(small < 0 && 0 > small && small == -7 && -7 == small);
+    ASSERT_TRUE(small != 7 && 7 != small && small <= -7 && -7 >= small);
+    ASSERT_TRUE(zero >= 0 && 1 >= zero && x > y);
+
+    auto copy = x;
+    copy *= copy;
+    copy.square();
+    copy /= x;
+    copy %= y;
+    copy += 42;
+    copy -= -42;
+    copy *= 3;
+    copy /= 2;
+    copy %= 1000000007;
+    auto expected = expected_a * expected_a;
+    expected.square();
+    expected /= expected_a;
+    expected %= expected_b;
+    expected = (expected + 84) * 3 / 2 % 1000000007;
+    ASSERT_EQ(text(copy), text(expected));
+    ASSERT_EQ(copy.get_allocator(), allocator);
+
+    std::string chars(20000, '\0');
+    auto product = x * y;
+    auto written = hausp::to_chars(chars.data(), chars.data() + chars.size(),
+                                   product, 7);
+    ASSERT_EQ(written.ec, std::errc());
+    Bound parsed(allocator);
+    auto read = hausp::from_chars(chars.data(), written.ptr, parsed, 7);
+    ASSERT_EQ(read.ptr, written.ptr);
+    ASSERT_EQ(parsed, product);
+}
+
+TEST_F(Tests, AllocatorIntermediates) {
+    using Group = hausp::detail::DefaultGroup;
+    using Pooled = hausp::BasicBigInt<Group,
+                                      std::pmr::polymorphic_allocator<Group>>;
+    auto text = [](const auto& value) {
+        std::stringstream ss;
+        ss << value;
+        return ss.str();
+    };
+    auto& thresholds = BigInt::thresholds();
+    auto saved = thresholds;
+    auto a = randomDigits(9000, 30);
+    auto b = randomDigits(6000, 31);
+    auto c = randomDigits(15000, 32);
+
+    std::pmr::monotonic_buffer_resource pool;
+    std::pmr::polymorphic_allocator<Group> allocator(&pool);
+    auto x = Pooled::fromString(a, 10, allocator);
+    auto y = Pooled::fromString(b, 10, allocator);
+    auto z = Pooled::fromString(c, 10, allocator);
+    Pooled w(allocator);
+    auto groups = [](const std::string& digits) {
+        return digits.size() * 3321 / 1000
+               / std::numeric_limits<Group>::digits;
+    };
+    ASSERT_GE(groups(a), thresholds.toom4);
+    ASSERT_GE(groups(b), thresholds.burnikelZiegler);
+    // Every intermediate comes from the scratch arena, none from the
+    // default resource
+    auto previous = std::pmr::set_default_resource(
+        std::pmr::null_memory_resource());
+    std::string product, quotient, remainder, barrett;
+    ASSERT_NO_THROW({
+        x *= y;
+        product = text(x);
+        x /= y;
+        z %= y;
+        remainder = text(z);
+        w = Pooled::fromString(c, 10, allocator);
+        thresholds.newton = thresholds.burnikelZiegler;
+        w /= y;
+        barrett = text(w);
+        thresholds = saved;
+        quotient = text(x);
+    });
+    std::pmr::set_default_resource(previous);
+    thresholds = saved;
+    ASSERT_EQ(product, text(fs(a) * fs(b)));
+    ASSERT_EQ(quotient, a);
+    ASSERT_EQ(remainder, text(fs(c) % fs(b)));
+    ASSERT_EQ(barrett, text(fs(c) / fs(b)));
+}
+
+TEST_F(Tests, ScratchArena) {
+    using hausp::ScratchArena;
+    auto a = fs(randomDigits(6000, 14));
+    auto b = fs(randomDigits(2500, 15));
+    auto product = a * b;
+    auto quotient = a / b;
+    auto remainder = a % b;
+    std::stringstream expected;
+    expected << a;
+
+    ScratchArena arena(1024);
+    ASSERT_EQ(ScratchArena::current(), nullptr);
+    for (int round = 0; round < 2; ++round) {
+        {
+            ScratchArena::Scope scope(arena);
+            ASSERT_EQ(ScratchArena::current(), &arena);
+            ASSERT_EQ(a * b, product);
+            ASSERT_EQ(a / b, quotient);
+            ASSERT_EQ(a % b, remainder);
+            std::stringstream ss;
+            ss << a;
+            ASSERT_EQ(ss.str(), expected.str());
+            ASSERT_EQ(fs(ss.str()), a);
+        }
+        ASSERT_EQ(ScratchArena::current(), nullptr);
+        auto used = arena.used();
+        ASSERT_GT(used, 0u);
+        ASSERT_EQ(a * b, product);
+        ASSERT_EQ(arena.used(), used);
+        arena.release();
+        ASSERT_EQ(arena.used(), 0u);
+    }
+
+    ScratchArena outer, inner;
+    ScratchArena::Scope outer_scope(outer);
+    {
+        ScratchArena::Scope inner_scope(inner);
+        ASSERT_EQ(a * b, product);
+    }
+    ASSERT_EQ(ScratchArena::current(), &outer);
+    ASSERT_EQ(outer.used(), 0u);
+    ASSERT_GT(inner.used(), 0u);
+}
+
+template<typename Group>
+void checkGroupKernels(const hausp::detail::GroupKernels<Group>& kernels) {
+    using namespace hausp::detail;
+    std::mt19937_64 generator(19);
+    auto random = [&](size_t n) {
+        std::vector<Group> groups(n);
+        for (auto& group : groups) {
+            auto bits = generator();
+            group = bits % 4 == 0 ? ~Group(0) : Group(generator());
+        }
+        return groups;
+    };
+    for (size_t n = 0; n < 40; ++n) {
+        auto a = random(n);
+        auto b = random(n);
+        auto r = random(n);
+        for (Group multiplier : {Group(0), ~Group(0), Group(generator())}) {
+            auto expected = r;
+            auto actual = r;
+            auto carry = addMulGroups1Scalar(expected.data(), a.data(), n,
+                                             multiplier, Group(7));
+            ASSERT_EQ(kernels.addMul1(actual.data(), a.data(), n,
+                                      multiplier, Group(7)), carry);
+            ASSERT_EQ(actual, expected);
+            carry = mulGroups1Scalar(expected.data(), a.data(), n,
+                                     multiplier, ~Group(0));
+            actual = a;
+            ASSERT_EQ(kernels.mul1(actual.data(), actual.data(), n,
+                                   multiplier, ~Group(0)), carry);
+            ASSERT_EQ(actual, expected);
+        }
+        for (Group carry : {Group(0), Group(1)}) {
+            std::vector<Group> expected(n), actual(n);
+            auto out = addGroupsScalar(expected.data(), a.data(), b.data(), n,
+                                       carry);
+            ASSERT_EQ(kernels.add(actual.data(), a.data(), b.data(), n,
+                                  carry), out);
+            ASSERT_EQ(actual, expected);
+            out = subGroupsScalar(expected.data(), a.data(), b.data(), n,
+                                  carry);
+            ASSERT_EQ(kernels.sub(actual.data(), a.data(), b.data(), n,
+                                  carry), out);
+            ASSERT_EQ(actual, expected);
+        }
+        for (unsigned shift : {1u, 7u, unsigned(8 * sizeof(Group) - 1)}) {
+            auto expected = a;
+            auto actual = a;
+            auto out = shiftLeftGroupsScalar(expected.data(), a.data(), n,
+                                             shift);
+            ASSERT_EQ(kernels.shiftLeft(actual.data(), actual.data(), n,
+                                        shift), out);
+            ASSERT_EQ(actual, expected);
+            actual = a;
+            out = shiftRightGroupsScalar(expected.data(), a.data(), n, shift);
+            ASSERT_EQ(kernels.shiftRight(actual.data(), actual.data(), n,
+                                         shift), out);
+            ASSERT_EQ(actual, expected);
+        }
+    }
+}
+
+TEST_F(Tests, GroupKernels) {
+    for (auto& table : kernelTables()) {
+        checkGroupKernels(table.groups32);
+#ifdef __SIZEOF_INT128__
+        checkGroupKernels(table.groups64);
+#endif
+    }
+}
+
+TEST_F(Tests, CpuDispatch) {
+    using hausp::CpuLevel;
+    using hausp::detail::parseCpuLevel;
+    ASSERT_LE(hausp::cpuLevel(), hausp::detail::detectCpuLevel());
+    ASSERT_EQ(parseCpuLevel("scalar", CpuLevel::AVX2), CpuLevel::SCALAR);
+    ASSERT_EQ(parseCpuLevel("sse4.1", CpuLevel::SCALAR), CpuLevel::SSE41);
+    ASSERT_EQ(parseCpuLevel("avx2", CpuLevel::SCALAR), CpuLevel::AVX2);
+    ASSERT_EQ(parseCpuLevel("adx", CpuLevel::SCALAR), CpuLevel::ADX);
+    ASSERT_EQ(parseCpuLevel("avx512", CpuLevel::SCALAR), CpuLevel::AVX512);
+    ASSERT_EQ(parseCpuLevel("AVX2", CpuLevel::ADX), CpuLevel::ADX);
+    ASSERT_EQ(parseCpuLevel("", CpuLevel::SSE41), CpuLevel::SSE41);
+
+    auto tables = kernelTables();
+    for (size_t i = 0; i < tables.size(); ++i) {
+        ASSERT_EQ(tables[i].level, CpuLevel(i));
+        ASSERT_EQ(tables[i].groups32.mult, nullptr);
+    }
+}
+
+TEST_F(Tests, VectorizedBasecase) {
+    using Group = uint64_t;
+    auto level = hausp::detail::detectCpuLevel();
+    auto mult = hausp::detail::selectKernels(level).groups64.mult;
+    if (!mult) {
+        GTEST_SKIP() << "no AVX-512 IFMA";
+    }
+    std::mt19937_64 generator(23);
+    auto schoolbook = [](const std::vector<Group>& a,
+                         const std::vector<Group>& b) {
+        std::vector<Group> r(a.size() + b.size(), 0);
+        for (size_t i = 0; i < b.size(); ++i) {
+            r[a.size() + i] = hausp::detail::addMulGroups1Scalar(
+                r.data() + i, a.data(), a.size(), b[i], Group(0));
+        }
+        return r;
+    };
+    for (size_t bn = 1; bn <= 48; ++bn) {
+        for (size_t an : {bn, bn + 1, bn + 13, 3 * bn + 5}) {
+            for (bool saturated : {false, true}) {
+                std::vector<Group> a(an), b(bn);
+                for (auto& group : a) {
+                    group = saturated ? ~Group(0) : generator();
+                }
+                for (auto& group : b) {
+                    group = saturated ? ~Group(0) : generator();
+                }
+                std::vector<Group> r(an + bn, 42);
+                if (!mult(r.data(), a.data(), an, b.data(), bn)) {
+                    ASSERT_EQ(r, std::vector<Group>(an + bn, 42));
+                    continue;
+                }
+                ASSERT_EQ(r, schoolbook(a, b));
+                if (an == bn && mult(r.data(), a.data(), an, a.data(), an)) {
+                    ASSERT_EQ(r, schoolbook(a, a));
+                }
+            }
+        }
+    }
+}
+
+TEST_F(Tests, InPlaceMultiplication) {
+    using Group = hausp::detail::DefaultGroup;
+    using Counted = hausp::BasicBigInt<Group,
+                                       std::pmr::polymorphic_allocator<Group>>;
+
+    auto x = fs(randomDigits(700, 16));
+    auto y = fs(randomDigits(300, 18));
+    ASSERT_EQ(x * y, y * x);
+    auto squared = x;
+    squared.square();
+    ASSERT_EQ(x * x, squared);
+
+    // Below and above the Toom-3 and Burnikel-Ziegler thresholds, the
+    // latter exercised by the reductions as much as by the products
+    auto& thresholds = BigInt::thresholds();
+    auto groups = 3000 * 3321 / 1000 / std::numeric_limits<Group>::digits;
+    ASSERT_GE(groups, thresholds.toom3);
+    ASSERT_GE(groups, thresholds.burnikelZiegler);
+    for (auto digits : {700, 3000}) {
+        auto text = randomDigits(digits, 16);
+        auto modulus = randomDigits(8 * digits / 3, 17);
+        auto expected = fs("1");
+        for (int i = 0; i < 30; ++i) {
+            expected = expected * fs(text) % fs(modulus);
+        }
+
+        Counting resource;
+        std::pmr::polymorphic_allocator<Group> allocator(&resource);
+        Counted acc(1, allocator);
+        Counted cx(Counted::fromString(text), allocator);
+        Counted cm(Counted::fromString(modulus), allocator);
+        for (int i = 0; i < 3; ++i) {
+            acc *= cx;
+        }
+        acc %= cm;
+        for (int i = 0; i < 3; ++i) {
+            acc *= cx;
+            acc %= cm;
+        }
+        acc = 1;
+        auto steady = resource.allocations;
+        auto heap = heapAllocations.load();
+        for (int i = 0; i < 30; ++i) {
+            acc *= cx;
+            acc %= cm;
+        }
+        ASSERT_EQ(resource.allocations, steady);
+        ASSERT_EQ(heapAllocations.load(), heap);
+        std::stringstream actual, wanted;
+        actual << acc;
+        wanted << expected;
+        ASSERT_EQ(actual.str(), wanted.str());
+    }
 }
 
 int main(int argc, char** argv) {